@@ -18,15 +18,18 @@ CRDFPlugin::CRDFPlugin()
 	std::filesystem::path dllPath = moduleNameRes != 0 ? pBuffer : "";
 
 	styleManager = std::make_unique<StyleManager>(dllPath);
+	pathPlugin = dllPath.parent_path();
 
 	auto logPath = dllPath.parent_path() / "RDFPlugin.log";
-	static plog::RollingFileAppender<plog::TxtFormatterUtcTime> rollingAppender(logPath.c_str(), 1000000, 1); // 1 MB of 1 file
+	static AsyncLogAppender<plog::TxtFormatterUtcTime> asyncAppender(logPath, 1000000, 1); // 1 MB of 1 file
+	asyncAppender.Start();
+	logAppender = &asyncAppender;
 #ifdef _DEBUG
 	auto severity = plog::debug;
 #else
 	auto severity = plog::none;
 #endif // _DEBUG
-	plog::init(severity, &rollingAppender);
+	plog::init(severity, &asyncAppender);
 	try {
 		auto cstrLogLevel = GetDataFromSettings(SETTING_LOG_LEVEL);
 		if (cstrLogLevel != nullptr) {
@@ -83,15 +86,19 @@ CRDFPlugin::CRDFPlugin()
 
 	// registration
 	RegisterTagItemType("RDF state", TAG_ITEM_TYPE_RDF_STATE);
+	RegisterTagItemType("RDF transmitting", TAG_ITEM_TYPE_RDF_TRANSMITTING);
+	RegisterTagItemType("RDF last TX", TAG_ITEM_TYPE_RDF_LAST_TX);
+	RegisterTagItemType("RDF TX count", TAG_ITEM_TYPE_RDF_TX_COUNT);
 
 	// initialize default settings
 	PLOGD << "initializing default settings";
 	ix::initNetSystem();
 	socketTrackAudio.setHandshakeTimeout(TRACKAUDIO_TIMEOUT_SEC);
-	socketTrackAudio.setMaxWaitBetweenReconnectionRetries(TRACKAUDIO_HEARTBEAT_SEC * 2000); // ms
+	reconnectTrackAudio.Reset(); // backoff is driven by reconnectTrackAudio
+	rttTrackAudio = -1;
 	socketTrackAudio.setPingInterval(TRACKAUDIO_HEARTBEAT_SEC);
 	socketTrackAudio.setOnMessageCallback(std::bind_front(&CRDFPlugin::TrackAudioMessageHandler, this));
-	setScreen[-1] = std::make_shared<draw_settings>();
+	setScreen[0] = std::make_shared<const draw_settings>();
 	LoadTrackAudioSettings();
 	LoadDrawingSettings();
 
@@ -102,9 +109,19 @@ CRDFPlugin::CRDFPlugin()
 
 CRDFPlugin::~CRDFPlugin()
 {
+	if (threadReplay.joinable()) {
+		threadReplay.request_stop();
+		threadReplay.join();
+	}
+	captureWriter.Stop();
+
 	// disconnect TrackAudio connection
 	PLOGD << "stopping TrackAudio WS";
+	reconnectTrackAudio.Join();
 	socketTrackAudio.stop();
+	if (futureTrackAudioVersion.valid()) {
+		futureTrackAudioVersion.wait();
+	}
 	ix::uninitNetSystem();
 
 	PLOGD << "destroying AFV hidden windows";
@@ -118,75 +135,131 @@ CRDFPlugin::~CRDFPlugin()
 	UnregisterClass("AfvBridgeHiddenWindowClass", nullptr);
 
 	PLOGD << "RDFPlugin is unloaded";
+	logAppender->Stop(); // flush pending records
 }
 
-auto CRDFPlugin::HiddenWndProcessRDFMessage(const std::string& message) -> void
+auto CRDFPlugin::HiddenWndProcessRDFMessage(const std::string_view& message, const bool& replayed) -> void
 {
+	RDF_TRACE_SCOPE("HiddenWndProcessRDFMessage");
+	if (!replayed && clockTransmission.Replaying()) { // the replay owns the transmission state
+		metrics.replayDropped.Add();
+		return;
+	}
+	rx_trace trace;
+	trace.received = std::chrono::steady_clock::now();
 	PLOGV << "AFV message: " << message;
-	std::unique_lock tlock(mtxTransmission);
-	if (message.size()) {
-		std::vector<std::string> callsigns;
-		std::istringstream f(message);
-		std::string s;
-		while (std::getline(f, s, ':')) {
-			callsigns.push_back(s);
-		}
-		// skip existing callsigns and clear redundant
-		std::erase_if(curTransmission, [&callsigns](const auto& item) {
-			return !std::erase(callsigns, item.first);
-			});
-		// add new station
-		for (const auto& cs : callsigns) {
-			auto dp = GenerateDrawPosition(cs);
-			if (dp.radius > 0) {
-				curTransmission[cs] = dp;
-			}
+	captureWriter.Record(CAPTURE_SOURCE_RDF, message);
+	metrics.afvRDFMessages.Add();
+	// format: callsign1:callsign2:...
+	std::vector<inline_callsign> callsigns;
+	ForEachToken(message, ':', [&](const std::string_view& token) {
+		if (token.size()) {
+			callsigns.push_back(token);
+		}
+		});
+	std::sort(callsigns.begin(), callsigns.end());
+	callsigns.erase(std::unique(callsigns.begin(), callsigns.end()), callsigns.end());
+	trace.parsed = std::chrono::steady_clock::now();
+
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	bool changed = false;
+	// diff: keep existing, collect new, then end rows not in message
+	std::vector<inline_callsign> newCallsigns;
+	std::vector<uint8_t> seen(curTransmission.Size(), 0);
+	for (const auto& cs : callsigns) {
+		if (auto row = FindTransmission(cs)) {
+			seen[*row] = 1;
+			TouchTransmission(*row);
+		}
+		else {
+			newCallsigns.push_back(cs);
 		}
-		preTransmission = curTransmission;
 	}
-	else {
-		curTransmission.clear();
+	for (size_t row = seen.size(); row-- > 0;) { // backwards, swap-remove only moves visited rows
+		if (!seen[row]) {
+			EndTransmission(row);
+			changed = true;
+		}
 	}
+	// add new station
+	for (const auto& cs : newCallsigns) {
+		if (auto sample = SamplePosition(cs)) {
+			draw_position dp;
+			dp.sample = *sample; // resolved per screen, see GetDrawGeometry
+			dp.trace = trace;
+			PublishTransmission(cs, dp);
+			changed = true;
+		}
+	}
+	tag_snapshot tags;
+	if (changed) {
+		tags = CollectTagIndex();
+	}
+	tlock.unlock();
+	if (changed) {
+		PublishTagIndex(tags);
+		RequestScreenRefresh();
+	}
+}
+
+auto CRDFPlugin::RequestScreenRefresh(void) -> void
+{
+	// only the first request of a burst posts, the rest ride along until the message is handled
+	metrics.refreshRequests.Add();
+	if (pendingRefresh.exchange(true)) return;
+	if (hiddenWindowRDF == nullptr || !PostMessage(hiddenWindowRDF, WM_RDF_REFRESH, NULL, NULL)) {
+		pendingRefresh = false;
+		return;
+	}
+	metrics.refreshPosted.Add();
+}
+
+auto CRDFPlugin::HiddenWndRefreshScreens(void) -> void
+{
+	// runs on EuroScope thread, clear first so changes published while redrawing post again
+	pendingRefresh = false;
+	screens.ForEach([](CRDFScreen& screen) {
+		if (screen.m_Opened) {
+			screen.RequestRefresh();
+		}
+		});
 }
 
-auto CRDFPlugin::HiddenWndProcessAFVMessage(const std::string& message) -> void
+auto CRDFPlugin::HiddenWndProcessAFVMessage(const std::string_view& message, const bool& replayed) -> void
 {
+	RDF_TRACE_SCOPE("HiddenWndProcessAFVMessage");
+	if (!replayed && clockTransmission.Replaying()) {
+		metrics.replayDropped.Add();
+		return;
+	}
 	// functions as AFV bridge
 	PLOGV << "AFV message: " << message;
+	captureWriter.Record(CAPTURE_SOURCE_AFV, message);
+	metrics.afvBridgeMessages.Add();
 	if (!message.size()) return;
 	// format: xxx.xxx:True:False + xxx.xx0:True:False
 
 	// parse message
-	std::queue<std::string> strings;
-	std::istringstream f(message);
-	std::string s;
-	while (std::getline(f, s, ':')) {
-		strings.push(s);
-	}
-	if (strings.size() != 3) return; // in case of incomplete message
-	int msgFrequency;
-	bool transmitX, receiveX;
-	try {
-		msgFrequency = FrequencyFromMHz(stod(strings.front()));
-		strings.pop();
-		receiveX = strings.front() == "True";
-		strings.pop();
-		transmitX = strings.front() == "True";
-		strings.pop();
-	}
-	catch (std::exception const& e) {
-		PLOGE << "AFV msg parse error: " << message << ", " << e.what();
-	}
-	catch (...) {
-		PLOGE << "Error parsing AFV message: " << message;
+	std::array<std::string_view, 3> tokens;
+	size_t numTokens = 0;
+	ForEachToken(message, ':', [&](const std::string_view& token) {
+		if (numTokens < tokens.size()) {
+			tokens[numTokens] = token;
+		}
+		numTokens++;
+		});
+	if (numTokens != tokens.size()) return; // in case of incomplete message
+	auto msgFrequency = FrequencyFromMHz(tokens[0]);
+	if (!msgFrequency) {
+		PLOGE << "AFV msg parse error: " << message;
 		return;
 	}
 
 	// update channel
 	chnl_state state;
-	state.frequency = msgFrequency;
-	state.rx = receiveX;
-	state.tx = transmitX;
+	state.frequency = *msgFrequency;
+	state.rx = tokens[1] == "True";
+	state.tx = tokens[2] == "True";
 	UpdateChannel(std::nullopt, state);
 }
 
@@ -205,12 +278,32 @@ auto CRDFPlugin::GetRGB(COLORREF& color, const std::string& settingValue) -> voi
 	}
 }
 
+auto CRDFPlugin::ApplyStyle(draw_settings& settings, const rdf_style& style) -> void
+{
+	settings.circleRadius = style.circleRadius;
+	settings.circlePrecision = style.circlePrecision;
+	settings.circleThreshold = style.circleThreshold;
+	settings.lowAltitude = style.lowAltitude;
+	settings.highAltitude = style.highAltitude;
+	settings.lowPrecision = style.lowPrecision;
+	settings.highPrecision = style.highPrecision;
+
+	// Convert RGB strings to COLORREF
+	GetRGB(settings.rdfRGB, style.rdfRGB);
+	GetRGB(settings.rdfConcurRGB, style.rdfConcurRGB);
+
+	settings.drawController = style.drawController;
+	settings.clusterOverlap = style.clusterOverlap;
+}
+
 auto CRDFPlugin::LoadTrackAudioSettings(void) -> void
 {
 	// get TrackAudio config
 	PLOGD << "loading TrackAudio settings";
 	addressTrackAudio = "127.0.0.1:49080";
 	modeTrackAudio = 1;
+	maxTransmissionSec = 60;
+	frameBudgetUs = FRAME_BUDGET_DEFAULT_US;
 
 	// Reload the styles
 	styleManager->LoadStyles();
@@ -218,42 +311,13 @@ auto CRDFPlugin::LoadTrackAudioSettings(void) -> void
 	// Apply default style after reloading
 	const rdf_style* defaultStyle = styleManager->GetDefaultStyle();
 	if (defaultStyle) {
-		std::unique_lock lock(mtxScreen);
-
-		// First apply to plugin settings (ID -1)
-		if (setScreen.find(-1) == setScreen.end()) {
-			setScreen[-1] = std::make_shared<draw_settings>();
-		}
-
-		// Then apply to all screens
-		for (auto& screen : vecScreen) {
-			if (setScreen.find(screen->m_ID) == setScreen.end()) {
-				setScreen[screen->m_ID] = std::make_shared<draw_settings>();
-			}
-
-			// Apply settings to this screen
-			auto& settings = setScreen[screen->m_ID];
-			settings->circleRadius = defaultStyle->circleRadius;
-			settings->circlePrecision = defaultStyle->circlePrecision;
-			settings->circleThreshold = defaultStyle->circleThreshold;
-			settings->lowAltitude = defaultStyle->lowAltitude;
-			settings->highAltitude = defaultStyle->highAltitude;
-			settings->lowPrecision = defaultStyle->lowPrecision;
-			settings->highPrecision = defaultStyle->highPrecision;
+		// Apply to all screens
+		screens.ForEach([&](CRDFScreen& screen) {
+			UpdateDrawingParam(screen.m_Handle.id, [&](draw_settings& settings) { ApplyStyle(settings, *defaultStyle); });
 
-			COLORREF rgb;
-			GetRGB(rgb, defaultStyle->rdfRGB);
-			settings->rdfRGB = rgb;
-			GetRGB(rgb, defaultStyle->rdfConcurRGB);
-			settings->rdfConcurRGB = rgb;
-
-			settings->drawController = defaultStyle->drawController;
-
-			// Save to ASR if needed
-			if (screen->m_ID != -1) {
-				screen->AddAsrDataToBeSaved(SETTING_STYLE, "Style", defaultStyle->name.c_str());
-			}
-		}
+			// Save to ASR
+			screen.AddAsrDataToBeSaved(SETTING_STYLE, "Style", defaultStyle->name.c_str());
+			});
 
 		auto imsg = std::format("RDF Style changed to {} (default)", defaultStyle->name);
 		PLOGI << imsg;
@@ -272,7 +336,21 @@ auto CRDFPlugin::LoadTrackAudioSettings(void) -> void
 				modeTrackAudio = mode;
 			}
 		}
-		PLOGD << "TrackAudio address: " << addressTrackAudio << ", mode: " << modeTrackAudio.load();
+		const char* cstrMaxTransmission = GetDataFromSettings(SETTING_MAX_TRANSMISSION);
+		if (cstrMaxTransmission != nullptr) {
+			int maxSec = std::stoi(cstrMaxTransmission);
+			if (maxSec >= 0) {
+				maxTransmissionSec = maxSec;
+			}
+		}
+		const char* cstrFrameBudget = GetDataFromSettings(SETTING_FRAME_BUDGET);
+		if (cstrFrameBudget != nullptr) {
+			int budget = std::stoi(cstrFrameBudget);
+			if (budget >= 0) {
+				frameBudgetUs = budget;
+			}
+		}
+		PLOGD << "TrackAudio address: " << addressTrackAudio << ", mode: " << modeTrackAudio.load() << ", max transmission: " << maxTransmissionSec.load() << " s, frame budget: " << frameBudgetUs.load() << " us";
 	}
 	catch (std::exception const& e)
 	{
@@ -287,17 +365,29 @@ auto CRDFPlugin::LoadTrackAudioSettings(void) -> void
 
 	// stop TrackAudio WebSocket
 	PLOGD << "stopping TrackAudio WebSocket";
+	reconnectTrackAudio.Join();
 	socketTrackAudio.stop();
+	if (futureTrackAudioVersion.valid()) {
+		futureTrackAudioVersion.wait();
+	}
+	{
+		std::lock_guard vlock(mtxTrackAudioVersion);
+		versionTrackAudio.reset();
+	}
 
 	// clears records
 	PLOGD << "clearing records";
 	std::unique_lock tlock(mtxTransmission);
-	curTransmission.clear();
-	preTransmission.clear();
+	ResetTransmissions();
+	auto tags = CollectTagIndex();
 	tlock.unlock();
+	PublishTagIndex(tags);
+	stationSync.Clear();
+	stationUpdates.Clear();
 
 	// initialize TrackAudio WebSocket
 	socketTrackAudio.setUrl(std::format("ws://{}{}", addressTrackAudio, TRACKAUDIO_PARAM_WS));
+	reconnectTrackAudio.Reset();
 	if (modeTrackAudio != -1) {
 		UpdateChannel(std::nullopt, std::nullopt);
 		socketTrackAudio.start();
@@ -305,18 +395,22 @@ auto CRDFPlugin::LoadTrackAudioSettings(void) -> void
 	}
 }
 
-auto CRDFPlugin::LoadDrawingSettings(const int& screenID) -> void
+auto CRDFPlugin::LoadDrawingSettings(const screen_handle& screen) -> void
 {
-	// pass screenID = -1 to use plugin settings, otherwise use ASR settings
+	// pass default handle to use plugin settings, otherwise use ASR settings
 	// Schematic: high altitude/precision optional. low altitude used for filtering regardless of others
 	// threshold < 0 will use circleRadius in pixel, circlePrecision for offset, low/high settings ignored
 	// lowPrecision > 0 and highPrecision > 0 and lowAltitude < highAltitude, will override circleRadius and circlePrecision with dynamic precision/radius
 	// lowPrecision > 0 but not meeting the above, will use lowPrecision (> 0) or circlePrecision
 
-	PLOGD << "loading drawing settings, ID " << screenID;
+	PLOGD << "loading drawing settings, ID " << screen.id;
+	CRDFScreen* screenPtr = screens.Get(screen);
+	if (screen.id != -1 && screenPtr == nullptr) {
+		PLOGW << "screen " << screen.id << " is closed";
+		return;
+	}
 	auto GetSetting = [&](const auto& varName) -> std::string {
-		if (screenID != -1) {
-			auto& screenPtr = vecScreen[screenID];
+		if (screenPtr != nullptr) {
 			if (screenPtr->m_Opened) {
 				auto ds = screenPtr->GetDataFromAsr(varName);
 				if (ds != nullptr) {
@@ -330,93 +424,82 @@ auto CRDFPlugin::LoadDrawingSettings(const int& screenID) -> void
 
 	try
 	{
-		std::unique_lock<std::shared_mutex> lock(mtxScreen);
-		// initialize settings
-		std::shared_ptr<draw_settings> targetSetting;;
-		auto itrSetting = setScreen.find(screenID);
-		if (itrSetting != setScreen.end()) { // use existing
-			targetSetting = itrSetting->second;
-		}
-		else { // create new based on plugin setting
-			PLOGD << "inserting new settings";
-			draw_settings ds = *setScreen[-1];
-			targetSetting = std::make_shared<draw_settings>(ds);
-			setScreen.insert({ screenID, targetSetting });
-		}
-
-		auto cstrRGB = GetSetting(SETTING_RGB);
-		if (cstrRGB.size())
-		{
-			GetRGB(targetSetting->rdfRGB, cstrRGB);
-		}
-		cstrRGB = GetSetting(SETTING_CONCURRENT_RGB);
-		if (cstrRGB.size())
-		{
-			GetRGB(targetSetting->rdfConcurRGB, cstrRGB);
-		}
-		auto cstrRadius = GetSetting(SETTING_CIRCLE_RADIUS);
-		if (cstrRadius.size())
-		{
-			int parsedRadius = std::stoi(cstrRadius);
-			if (parsedRadius > 0) {
-				targetSetting->circleRadius = parsedRadius;
-				PLOGV << SETTING_CIRCLE_RADIUS << ": " << targetSetting->circleRadius;
-			}
-		}
-		auto cstrThreshold = GetSetting(SETTING_THRESHOLD);
-		if (cstrThreshold.size())
-		{
-			targetSetting->circleThreshold = std::stoi(cstrThreshold);
-			PLOGV << SETTING_THRESHOLD << ": " << targetSetting->circleThreshold;
-		}
-		auto cstrPrecision = GetSetting(SETTING_PRECISION);
-		if (cstrPrecision.size())
-		{
-			int parsedPrecision = std::stoi(cstrPrecision);
-			if (parsedPrecision >= 0) {
-				targetSetting->circlePrecision = parsedPrecision;
-				PLOGV << SETTING_PRECISION << ": " << targetSetting->circlePrecision;
-			}
-		}
-		auto cstrLowAlt = GetSetting(SETTING_LOW_ALTITUDE);
-		if (cstrLowAlt.size())
-		{
-			targetSetting->lowAltitude = std::stoi(cstrLowAlt);
-			PLOGV << SETTING_LOW_ALTITUDE << ": " << targetSetting->lowAltitude;
-		}
-		auto cstrHighAlt = GetSetting(SETTING_HIGH_ALTITUDE);
-		if (cstrHighAlt.size())
-		{
-			int parsedAlt = std::stoi(cstrHighAlt);
-			if (parsedAlt > 0) {
-				targetSetting->highAltitude = parsedAlt;
-				PLOGV << SETTING_HIGH_ALTITUDE << ": " << targetSetting->highAltitude;
-			}
-		}
-		auto cstrLowPrecision = GetSetting(SETTING_LOW_PRECISION);
-		if (cstrLowPrecision.size())
-		{
-			int parsedPrecision = std::stoi(cstrLowPrecision);
-			if (parsedPrecision >= 0) {
-				targetSetting->lowPrecision = parsedPrecision;
-				PLOGV << SETTING_LOW_PRECISION << ": " << targetSetting->lowPrecision;
-			}
-		}
-		auto cstrHighPrecision = GetSetting(SETTING_HIGH_PRECISION);
-		if (cstrHighPrecision.size())
-		{
-			int parsedPrecision = std::stoi(cstrHighPrecision);
-			if (parsedPrecision >= 0) {
-				targetSetting->highPrecision = parsedPrecision;
-				PLOGV << SETTING_HIGH_PRECISION << ": " << targetSetting->highPrecision;
-			}
-		}
-		auto cstrController = GetSetting(SETTING_DRAW_CONTROLLERS);
-		if (cstrController.size())
-		{
-			targetSetting->drawController = (bool)std::stoi(cstrController);
-			PLOGV << SETTING_DRAW_CONTROLLERS << ": " << targetSetting->drawController;
-		}
+		// new screens start from plugin setting, nothing is applied if any value fails to parse
+		UpdateDrawingParam(screen.id, [&](draw_settings& targetSetting) {
+			auto cstrRGB = GetSetting(SETTING_RGB);
+			if (cstrRGB.size())
+			{
+				GetRGB(targetSetting.rdfRGB, cstrRGB);
+			}
+			cstrRGB = GetSetting(SETTING_CONCURRENT_RGB);
+			if (cstrRGB.size())
+			{
+				GetRGB(targetSetting.rdfConcurRGB, cstrRGB);
+			}
+			auto cstrRadius = GetSetting(SETTING_CIRCLE_RADIUS);
+			if (cstrRadius.size())
+			{
+				int parsedRadius = std::stoi(cstrRadius);
+				if (parsedRadius > 0) {
+					targetSetting.circleRadius = parsedRadius;
+					PLOGV << SETTING_CIRCLE_RADIUS << ": " << targetSetting.circleRadius;
+				}
+			}
+			auto cstrThreshold = GetSetting(SETTING_THRESHOLD);
+			if (cstrThreshold.size())
+			{
+				targetSetting.circleThreshold = std::stoi(cstrThreshold);
+				PLOGV << SETTING_THRESHOLD << ": " << targetSetting.circleThreshold;
+			}
+			auto cstrPrecision = GetSetting(SETTING_PRECISION);
+			if (cstrPrecision.size())
+			{
+				int parsedPrecision = std::stoi(cstrPrecision);
+				if (parsedPrecision >= 0) {
+					targetSetting.circlePrecision = parsedPrecision;
+					PLOGV << SETTING_PRECISION << ": " << targetSetting.circlePrecision;
+				}
+			}
+			auto cstrLowAlt = GetSetting(SETTING_LOW_ALTITUDE);
+			if (cstrLowAlt.size())
+			{
+				targetSetting.lowAltitude = std::stoi(cstrLowAlt);
+				PLOGV << SETTING_LOW_ALTITUDE << ": " << targetSetting.lowAltitude;
+			}
+			auto cstrHighAlt = GetSetting(SETTING_HIGH_ALTITUDE);
+			if (cstrHighAlt.size())
+			{
+				int parsedAlt = std::stoi(cstrHighAlt);
+				if (parsedAlt > 0) {
+					targetSetting.highAltitude = parsedAlt;
+					PLOGV << SETTING_HIGH_ALTITUDE << ": " << targetSetting.highAltitude;
+				}
+			}
+			auto cstrLowPrecision = GetSetting(SETTING_LOW_PRECISION);
+			if (cstrLowPrecision.size())
+			{
+				int parsedPrecision = std::stoi(cstrLowPrecision);
+				if (parsedPrecision >= 0) {
+					targetSetting.lowPrecision = parsedPrecision;
+					PLOGV << SETTING_LOW_PRECISION << ": " << targetSetting.lowPrecision;
+				}
+			}
+			auto cstrHighPrecision = GetSetting(SETTING_HIGH_PRECISION);
+			if (cstrHighPrecision.size())
+			{
+				int parsedPrecision = std::stoi(cstrHighPrecision);
+				if (parsedPrecision >= 0) {
+					targetSetting.highPrecision = parsedPrecision;
+					PLOGV << SETTING_HIGH_PRECISION << ": " << targetSetting.highPrecision;
+				}
+			}
+			auto cstrController = GetSetting(SETTING_DRAW_CONTROLLERS);
+			if (cstrController.size())
+			{
+				targetSetting.drawController = (bool)std::stoi(cstrController);
+				PLOGV << SETTING_DRAW_CONTROLLERS << ": " << targetSetting.drawController;
+			}
+			});
 	}
 	catch (std::exception const& e)
 	{
@@ -430,11 +513,16 @@ auto CRDFPlugin::LoadDrawingSettings(const int& screenID) -> void
 	}
 }
 
-auto CRDFPlugin::ProcessDrawingCommand(const std::string& command, const int& screenID) -> bool
+auto CRDFPlugin::ProcessDrawingCommand(const std::string& command, const screen_handle& screen) -> bool
 {
+	CRDFScreen* screenPtr = screens.Get(screen);
+	if (screen.id != -1 && screenPtr == nullptr) {
+		PLOGW << "screen " << screen.id << " is closed";
+		return false;
+	}
 	auto SaveSetting = [&](const auto& varName, const auto& varDescr, const auto& val) -> void {
-		if (screenID != -1) {
-			vecScreen[screenID]->AddAsrDataToBeSaved(varName, varDescr, val);
+		if (screenPtr != nullptr) {
+			screenPtr->AddAsrDataToBeSaved(varName, varDescr, val);
 			auto imsg = std::format("{}: {} (ASR)", varDescr, val);
 			PLOGI << imsg;
 			DisplayInfoMessage(imsg);
@@ -461,32 +549,8 @@ auto CRDFPlugin::ProcessDrawingCommand(const std::string& command, const int& sc
 
 			const rdf_style* style = styleManager->GetStyle(styleName);
 			if (style) {
-				std::unique_lock lock(mtxScreen);
-
-				// Initialize settings if needed
-				if (setScreen.find(screenID) == setScreen.end()) {
-					setScreen[screenID] = std::make_shared<draw_settings>();
-				}
-
-				auto& settings = setScreen[screenID];
-
 				// Apply all style settings
-				settings->circleRadius = style->circleRadius;
-				settings->circlePrecision = style->circlePrecision;
-				settings->circleThreshold = style->circleThreshold;
-				settings->lowAltitude = style->lowAltitude;
-				settings->highAltitude = style->highAltitude;
-				settings->lowPrecision = style->lowPrecision;
-				settings->highPrecision = style->highPrecision;
-
-				// Convert RGB strings to COLORREF
-				COLORREF rgb;
-				GetRGB(rgb, style->rdfRGB);
-				settings->rdfRGB = rgb;
-				GetRGB(rgb, style->rdfConcurRGB);
-				settings->rdfConcurRGB = rgb;
-
-				settings->drawController = style->drawController;
+				UpdateDrawingParam(screen.id, [&](draw_settings& settings) { ApplyStyle(settings, *style); });
 
 				// Save settings
 				SaveSetting(SETTING_STYLE, "Style", style->name.c_str());
@@ -502,98 +566,88 @@ auto CRDFPlugin::ProcessDrawingCommand(const std::string& command, const int& sc
 
 		// Handle ON/OFF commands
 		if (cmd == ".RDF ON" || cmd == ".RDF OFF") {
-			std::unique_lock lock(mtxScreen);
 			int altitude = (cmd == ".RDF ON") ? 0 : 999999;
-
-			// Initialize settings if needed
-			if (setScreen.find(screenID) == setScreen.end()) {
-				draw_settings ds = *setScreen[-1];
-				setScreen[screenID] = std::make_shared<draw_settings>(ds);
-			}
-
-			setScreen[screenID]->lowAltitude = altitude;
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.lowAltitude = altitude; });
 			SaveSetting(SETTING_LOW_ALTITUDE, "Altitude (low)", std::to_string(altitude).c_str());
 			return true;
 		}
 
-		// Rest of the command handling...
-		std::unique_lock lock(mtxScreen);
-		std::shared_ptr<draw_settings> targetSetting = setScreen[screenID];
-
+		// Rest of the command handling, settings are swapped before messages are displayed
 		std::smatch match;
 		std::regex rxRGB(R"(^.RDF (RGB|CTRGB) (\S+)$)", std::regex_constants::icase);
 		if (regex_match(command, match, rxRGB)) {
 			auto bufferMode = match[1].str();
 			auto bufferRGB = match[2].str();
 			std::transform(bufferMode.begin(), bufferMode.end(), bufferMode.begin(), ::toupper);
-			if (bufferMode == "RGB") {
-				COLORREF prevRGB = targetSetting->rdfRGB;
-				GetRGB(targetSetting->rdfRGB, bufferRGB);
-				if (targetSetting->rdfRGB != prevRGB) {
-					SaveSetting(SETTING_RGB, "RGB", bufferRGB.c_str());
-					return true;
-				}
-			}
-			else {
-				COLORREF prevRGB = targetSetting->rdfConcurRGB;
-				GetRGB(targetSetting->rdfConcurRGB, bufferRGB);
-				if (targetSetting->rdfConcurRGB != prevRGB) {
+			bool concur = bufferMode != "RGB";
+			bool changed = false;
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) {
+				COLORREF& targetRGB = concur ? settings.rdfConcurRGB : settings.rdfRGB;
+				COLORREF prevRGB = targetRGB;
+				GetRGB(targetRGB, bufferRGB);
+				changed = targetRGB != prevRGB;
+				});
+			if (changed) {
+				if (concur) {
 					SaveSetting(SETTING_CONCURRENT_RGB, "Concurrent RGB", bufferRGB.c_str());
-					return true;
 				}
+				else {
+					SaveSetting(SETTING_RGB, "RGB", bufferRGB.c_str());
+				}
+				return true;
 			}
 		}
 		// no need for regex
 		int bufferRadius;
 		if (sscanf_s(cmd.c_str(), ".RDF RADIUS %d", &bufferRadius) == 1) {
 			if (bufferRadius > 0) {
-				targetSetting->circleRadius = bufferRadius;
-				SaveSetting(SETTING_CIRCLE_RADIUS, "Radius", std::to_string(targetSetting->circleRadius).c_str());
+				UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.circleRadius = bufferRadius; });
+				SaveSetting(SETTING_CIRCLE_RADIUS, "Radius", std::to_string(bufferRadius).c_str());
 				return true;
 			}
 		}
 		int bufferThreshold;
 		if (sscanf_s(cmd.c_str(), ".RDF THRESHOLD %d", &bufferThreshold) == 1) {
-			targetSetting->circleThreshold = bufferThreshold;
-			SaveSetting(SETTING_THRESHOLD, "Threshold", std::to_string(targetSetting->circleThreshold).c_str());
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.circleThreshold = bufferThreshold; });
+			SaveSetting(SETTING_THRESHOLD, "Threshold", std::to_string(bufferThreshold).c_str());
 			return true;
 		}
 		int bufferAltitude;
 		if (sscanf_s(cmd.c_str(), ".RDF ALTITUDE L%d", &bufferAltitude) == 1) {
-			targetSetting->lowAltitude = bufferAltitude;
-			SaveSetting(SETTING_LOW_ALTITUDE, "Altitude (low)", std::to_string(targetSetting->lowAltitude).c_str());
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.lowAltitude = bufferAltitude; });
+			SaveSetting(SETTING_LOW_ALTITUDE, "Altitude (low)", std::to_string(bufferAltitude).c_str());
 			return true;
 		}
 		if (sscanf_s(cmd.c_str(), ".RDF ALTITUDE H%d", &bufferAltitude) == 1) {
-			targetSetting->highAltitude = bufferAltitude;
-			SaveSetting(SETTING_HIGH_ALTITUDE, "Altitude (high)", std::to_string(targetSetting->highAltitude).c_str());
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.highAltitude = bufferAltitude; });
+			SaveSetting(SETTING_HIGH_ALTITUDE, "Altitude (high)", std::to_string(bufferAltitude).c_str());
 			return true;
 		}
 		int bufferPrecision;
 		if (sscanf_s(cmd.c_str(), ".RDF PRECISION L%d", &bufferPrecision) == 1) {
 			if (bufferPrecision >= 0) {
-				targetSetting->lowPrecision = bufferPrecision;
-				SaveSetting(SETTING_LOW_PRECISION, "Precision (low)", std::to_string(targetSetting->lowPrecision).c_str());
+				UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.lowPrecision = bufferPrecision; });
+				SaveSetting(SETTING_LOW_PRECISION, "Precision (low)", std::to_string(bufferPrecision).c_str());
 				return true;
 			}
 		}
 		if (sscanf_s(cmd.c_str(), ".RDF PRECISION H%d", &bufferPrecision) == 1) {
 			if (bufferPrecision >= 0) {
-				targetSetting->highPrecision = bufferPrecision;
-				SaveSetting(SETTING_HIGH_PRECISION, "Precision (high)", std::to_string(targetSetting->highPrecision).c_str());
+				UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.highPrecision = bufferPrecision; });
+				SaveSetting(SETTING_HIGH_PRECISION, "Precision (high)", std::to_string(bufferPrecision).c_str());
 				return true;
 			}
 		}
 		if (sscanf_s(cmd.c_str(), ".RDF PRECISION %d", &bufferPrecision) == 1) {
 			if (bufferPrecision >= 0) {
-				targetSetting->circlePrecision = bufferPrecision;
-				SaveSetting(SETTING_PRECISION, "Precision", std::to_string(targetSetting->circlePrecision).c_str());
+				UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.circlePrecision = bufferPrecision; });
+				SaveSetting(SETTING_PRECISION, "Precision", std::to_string(bufferPrecision).c_str());
 				return true;
 			}
 		}
 		int bufferCtrl;
 		if (sscanf_s(cmd.c_str(), ".RDF CONTROLLER %d", &bufferCtrl) == 1) {
-			targetSetting->drawController = bufferCtrl;
+			UpdateDrawingParam(screen.id, [&](draw_settings& settings) { settings.drawController = bufferCtrl; });
 			SaveSetting(SETTING_DRAW_CONTROLLERS, "Draw controllers", std::to_string(bufferCtrl).c_str());
 			return true;
 		}
@@ -609,9 +663,11 @@ auto CRDFPlugin::ProcessDrawingCommand(const std::string& command, const int& sc
 	return false;
 }
 
-auto CRDFPlugin::GenerateDrawPosition(std::string callsign) -> draw_position
+auto CRDFPlugin::SamplePosition(const inline_callsign& callsign) -> std::optional<position_sample>
 {
-	// return radius=0 for no draw
+	RDF_TRACE_SCOPE("SamplePosition");
+	// random draws are taken here once, screens only scale them, see ResolveDrawPosition
+	metrics.drawPositionCalls.Add();
 
 	// randoms
 	static std::random_device randomDevice;
@@ -619,73 +675,293 @@ auto CRDFPlugin::GenerateDrawPosition(std::string callsign) -> draw_position
 	static std::uniform_real_distribution<> disBearing(0.0, 360.0);
 	static std::normal_distribution<> disDistance(0, 1.0);
 
-	auto radarTarget = RadarTargetSelect(callsign.c_str());
-	auto controller = ControllerSelect(callsign.c_str());
-	if (!radarTarget.IsValid() && controller.IsValid() && callsign.back() >= 'A' && callsign.back() <= 'Z') {
+	auto radarTarget = RadarTargetSelect(callsign.CStr());
+	auto controller = ControllerSelect(callsign.CStr());
+	std::string_view callsignView = callsign.View();
+	if (!radarTarget.IsValid() && controller.IsValid() && callsignView.back() >= 'A' && callsignView.back() <= 'Z') {
 		// dump last character and find callsign again
-		std::string callsign_dump = callsign.substr(0, callsign.size() - 1);
-		radarTarget = RadarTargetSelect(callsign_dump.c_str());
-	}
-	auto params = GetDrawingParam();
-	int circleRadius = params.circleRadius;
-	int circlePrecision = params.circlePrecision;
-	int circleThreshold = params.circleThreshold;
-	int lowAltitude = params.lowAltitude;
-	int highAltitude = params.highAltitude;
-	int lowPrecision = params.lowPrecision;
-	int highPrecision = params.highPrecision;
-	bool drawController = params.drawController;
+		inline_callsign callsign_dump(callsignView.substr(0, callsignView.size() - 1));
+		radarTarget = RadarTargetSelect(callsign_dump.CStr());
+	}
+	position_sample sample;
 	if (radarTarget.IsValid()) {
-		int alt = radarTarget.GetPosition().GetPressureAltitude();
-		if (alt >= lowAltitude) { // need to draw, see Schematic in LoadSettings
-			EuroScopePlugIn::CPosition pos = radarTarget.GetPosition().GetPosition();
-			double radius = circleRadius;
-			// determines offset
-			double offset = circlePrecision;
-			if (circleThreshold >= 0 && (lowPrecision > 0 || circlePrecision > 0)) {
-				if (highPrecision > 0 && highAltitude > lowAltitude) {
-					offset = (double)lowPrecision + (double)(alt - lowAltitude) * (double)(highPrecision - lowPrecision) / (double)(highAltitude - lowAltitude);
-				}
-				else {
-					offset = lowPrecision > 0 ? lowPrecision : circlePrecision;
-				}
-				radius = offset;
-			}
-			if (offset > 0) { // add random offset
-				double distance = abs(disDistance(rdGenerator)) / 3.0 * offset;
-				double bearing = disBearing(rdGenerator);
-				AddOffset(pos, bearing, distance);
-			}
-			return draw_position(pos, radius);
+		EuroScopePlugIn::CPosition pos = radarTarget.GetPosition().GetPosition();
+		sample.latitude = pos.m_Latitude;
+		sample.longitude = pos.m_Longitude;
+		sample.altitude = radarTarget.GetPosition().GetPressureAltitude();
+		sample.bearing = disBearing(rdGenerator);
+		sample.spread = abs(disDistance(rdGenerator)) / 3.0;
+	}
+	else if (controller.IsValid()) {
+		EuroScopePlugIn::CPosition pos = controller.GetPosition();
+		sample.latitude = pos.m_Latitude;
+		sample.longitude = pos.m_Longitude;
+		sample.controller = true;
+	}
+	else {
+		metrics.drawPositionFailures.Add();
+		return std::nullopt;
+	}
+	if (!GetTrackFilter().Tracks(sample)) { // below every screen, or controller with no screen drawing them
+		metrics.drawPositionFailures.Add();
+		return std::nullopt;
+	}
+	return sample;
+}
+
+auto CRDFPlugin::GetTrackFilter(void) -> track_filter
+{
+	// lock free, any thread, plugin settings count for screens without own settings
+	track_filter filter;
+	for (const auto& slot : setScreen) {
+		if (auto settings = slot.load()) {
+			filter.Add(settings->lowAltitude, settings->drawController);
+		}
+	}
+	return filter;
+}
+
+inline static auto ResolveDrawPosition(TransmissionTable& rows, const size_t& row, const draw_settings& params) -> bool
+{
+	// writes position and radius of row, returns false for no draw on this screen
+	const position_sample& sample = rows.sample[row];
+	EuroScopePlugIn::CPosition pos;
+	pos.m_Latitude = sample.latitude;
+	pos.m_Longitude = sample.longitude;
+	auto Store = [&](const EuroScopePlugIn::CPosition& position, const double& radius) -> bool {
+		rows.latitude[row] = position.m_Latitude;
+		rows.longitude[row] = position.m_Longitude;
+		rows.radius[row] = radius;
+		return radius > 0;
+		};
+	if (sample.controller) {
+		return params.drawController && Store(pos, params.circleRadius);
+	}
+	int alt = sample.altitude;
+	if (alt < params.lowAltitude) return false; // no need to draw, see Schematic in LoadSettings
+	double radius = params.circleRadius;
+	// determines offset
+	double offset = params.circlePrecision;
+	if (params.circleThreshold >= 0 && (params.lowPrecision > 0 || params.circlePrecision > 0)) {
+		if (params.highPrecision > 0 && params.highAltitude > params.lowAltitude) {
+			offset = (double)params.lowPrecision + (double)(alt - params.lowAltitude) * (double)(params.highPrecision - params.lowPrecision) / (double)(params.highAltitude - params.lowAltitude);
 		}
+		else {
+			offset = params.lowPrecision > 0 ? params.lowPrecision : params.circlePrecision;
+		}
+		radius = offset;
 	}
-	else if (drawController && controller.IsValid()) {
-		auto pos = controller.GetPosition();
-		return draw_position(pos, circleRadius);
+	if (offset > 0) { // add random offset
+		AddOffset(pos, sample.bearing, sample.spread * offset);
 	}
-	return draw_position();
+	return Store(pos, radius);
 }
 
-auto CRDFPlugin::TrackAudioTransmissionHandler(const nlohmann::json& data, const bool& rxEnd) -> void
+auto CRDFPlugin::TrackAudioTransmissionHandler(const nlohmann::json& data, const bool& rxEnd, const rx_trace& trace) -> void
 {
 	// handler for "kRxBegin" & "kRxEnd"
 	// pass rxEnd = true for "kRxEnd"
-	std::unique_lock tlock(mtxTransmission);
-	std::string callsign = data.at("callsign");
-	auto it = curTransmission.find(callsign);
-	if (it != curTransmission.end()) {
-		if (rxEnd) {
-			curTransmission.erase(it);
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	bool changed = false;
+	inline_callsign callsign(data.at("callsign").get_ref<const std::string&>());
+	int frequency = FrequencyFromHz(data.value("pFrequencyHz", 0));
+	auto row = FindTransmission(callsign);
+	if (rxEnd) {
+		// other stations may still receive it, an unknown pair ends all
+		if (row && (!frequencyIndex.Remove(curTransmission.id[*row], frequency) || !frequencyIndex.Count(curTransmission.id[*row]))) {
+			EndTransmission(*row);
+			changed = true;
+		}
+	}
+	else if (row) {
+		// same transmission on another frequency (or cross-coupled station), keep position
+		changed = AddReception(*row, frequency);
+		TouchTransmission(*row);
+	}
+	else {
+		if (auto sample = SamplePosition(callsign)) {
+			draw_position dp;
+			dp.sample = *sample; // resolved per screen, see GetDrawGeometry
+			dp.trace = trace;
+			dp.frequency = frequency;
+			PublishTransmission(callsign, dp);
+			changed = true;
 		}
 	}
-	else if (!rxEnd) {
-		auto dp = GenerateDrawPosition(callsign);
-		if (dp.radius > 0) {
-			curTransmission[callsign] = dp;
+	tag_snapshot tags;
+	if (changed) {
+		tags = CollectTagIndex();
+	}
+	tlock.unlock();
+	if (changed) {
+		PublishTagIndex(tags);
+		RequestScreenRefresh();
+	}
+}
+
+auto CRDFPlugin::PublishTransmission(const inline_callsign& callsign, draw_position& drawPosition) -> void
+{
+	// caller holds unique lock on mtxTransmission
+	auto& trace = drawPosition.trace;
+	trace.positioned = std::chrono::steady_clock::now();
+	trace.published = trace.positioned;
+	metrics.rxParse.Record(trace.parsed - trace.received);
+	metrics.rxPosition.Record(trace.positioned - trace.parsed);
+	drawPosition.started = clockTransmission.Now();
+	size_t row = curTransmission.Set(callsignIds.Acquire(callsign), callsign, drawPosition); // released in EndTransmission
+	generationTransmission++;
+	AddReception(row, drawPosition.frequency);
+	curTransmission.trace[row].published = std::chrono::steady_clock::now();
+	metrics.rxPublish.Record(curTransmission.trace[row].published - trace.positioned);
+	TouchTransmission(row);
+}
+
+auto CRDFPlugin::AddReception(const size_t& row, const int& frequency) -> bool
+{
+	// caller holds unique lock on mtxTransmission
+	// the bucket only holds open intervals, so everything in it overlaps the new reception
+	uint32_t id = curTransmission.id[row];
+	if (!frequencyIndex.Add(id, frequency)) return false;
+	generationTransmission++; // RX filter view and overlap flags
+	bool overlap = false;
+	frequencyIndex.ForEach([&](const int& f) { return f == frequency; }, [&](const uint32_t& other) {
+		if (other == id) return;
+		if (auto r = curTransmission.Find(other)) {
+			curTransmission.flags[*r] |= TX_FLAG_OVERLAP;
 		}
+		overlap = true;
+		});
+	if (overlap) {
+		curTransmission.flags[row] |= TX_FLAG_OVERLAP;
+		overlapsFrequency[frequency]++;
+		metrics.transmissionOverlaps.Add();
+	}
+	return true;
+}
+
+inline static auto ExpiryTick(const std::chrono::steady_clock::time_point& time) -> int64_t {
+	return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+auto CRDFPlugin::TouchTransmission(const size_t& row) -> void
+{
+	// caller holds unique lock on mtxTransmission
+	auto& lastSeen = curTransmission.lastSeen[row];
+	lastSeen = clockTransmission.Now();
+	int maxSec = maxTransmissionSec;
+	// one live entry per row, when it fires it re-checks lastSeen
+	if (maxSec > 0 && !curTransmission.expiry[row]) {
+		curTransmission.expiry[row] = expiryTransmission.Schedule(curTransmission.id[row], ExpiryTick(lastSeen) + maxSec + 1);
 	}
-	if (curTransmission.size()) {
-		preTransmission = curTransmission;
+}
+
+auto CRDFPlugin::ExpireTransmissions(void) -> void
+{
+	// drops transmissions not seen for SETTING_MAX_TRANSMISSION, e.g. lost kRxEnd
+	auto now = clockTransmission.Now();
+	auto maxAge = std::chrono::seconds(maxTransmissionSec.load());
+	size_t expired = 0;
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	expiryTransmission.Advance(ExpiryTick(now), [&](const uint32_t& id, const int64_t& tick) {
+		auto row = curTransmission.Find(id);
+		if (!row || curTransmission.expiry[*row] != tick) return; // ended, or the ID now belongs to another transmission
+		curTransmission.expiry[*row] = 0;
+		if (maxAge.count() <= 0) return;
+		if (now - curTransmission.lastSeen[*row] >= maxAge) {
+			PLOGW << "transmission expired: " << curTransmission.callsign[*row];
+			EndTransmission(*row);
+			expired++;
+		}
+		else {
+			// refreshed or limit raised, the row keeps exactly one entry
+			curTransmission.expiry[*row] = expiryTransmission.Schedule(id, ExpiryTick(curTransmission.lastSeen[*row] + maxAge) + 1);
+		}
+		});
+	auto tags = CollectTagIndex(); // also ages TX counts
+	tlock.unlock();
+	PublishTagIndex(tags);
+	if (expired) {
+		metrics.transmissionsExpired.Add(expired);
+		RequestScreenRefresh();
+	}
+}
+
+auto CRDFPlugin::EndTransmission(const size_t& row) -> void
+{
+	// caller holds unique lock on mtxTransmission, moves the transmission into history
+	history_entry entry;
+	entry.callsign = curTransmission.callsign[row];
+	entry.sample = curTransmission.sample[row];
+	entry.frequency = curTransmission.frequency[row];
+	entry.start = curTransmission.started[row];
+	entry.end = clockTransmission.Now();
+	entry.overlapped = curTransmission.flags[row] & TX_FLAG_OVERLAP;
+	historyTransmission.Push(std::move(entry)); // holds its own reference, the ID stays the same
+	uint32_t id = curTransmission.id[row];
+	frequencyIndex.RemoveAll(id);
+	curTransmission.Remove(row);
+	callsignIds.Release(id);
+	generationTransmission++;
+}
+
+auto CRDFPlugin::FindTransmission(const inline_callsign& callsign) const -> std::optional<size_t>
+{
+	// caller holds lock on mtxTransmission
+	auto id = callsignIds.Find(callsign);
+	if (!id) return std::nullopt;
+	return curTransmission.Find(*id);
+}
+
+auto CRDFPlugin::ResetTransmissions(void) -> void
+{
+	// caller holds unique lock on mtxTransmission, drops current transmissions and history
+	for (const auto& id : curTransmission.id) {
+		callsignIds.Release(id);
+	}
+	curTransmission.Clear();
+	frequencyIndex.Clear();
+	expiryTransmission.Clear();
+	historyTransmission.Clear();
+	generationTransmission++;
+}
+
+auto CRDFPlugin::CollectTagIndex(void) -> tag_snapshot
+{
+	// caller holds unique lock on mtxTransmission, flat copy only
+	tag_snapshot snapshot;
+	snapshot.sequence = ++sequenceTagIndex;
+	snapshot.windowStart = clockTransmission.Now() - std::chrono::seconds(HISTORY_DEFAULT_SEC);
+	snapshot.sources.reserve(curTransmission.Size() + HISTORY_CAPACITY);
+	for (size_t row = 0; row < curTransmission.Size(); row++) {
+		snapshot.sources.push_back({ curTransmission.callsign[row], curTransmission.id[row], std::nullopt });
+	}
+	historyTransmission.ForEachSince(std::chrono::steady_clock::time_point(), [&](const history_entry& entry) {
+		snapshot.sources.push_back({ entry.callsign, entry.id, entry.end });
+		});
+	return snapshot;
+}
+
+auto CRDFPlugin::PublishTagIndex(const tag_snapshot& snapshot) -> void
+{
+	// without lock on mtxTransmission
+	if (!tagIndex.Publish(TagIndex::Aggregate(snapshot), snapshot.sequence)) {
+		PLOGV << "tag index snapshot " << snapshot.sequence << " superseded";
+	}
+}
+
+auto CRDFPlugin::ClearTransmissions(void) -> void
+{
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	bool changed = !curTransmission.Empty();
+	for (size_t row = curTransmission.Size(); row-- > 0;) {
+		EndTransmission(row);
+	}
+	expiryTransmission.Clear();
+	auto tags = CollectTagIndex();
+	tlock.unlock();
+	PublishTagIndex(tags);
+	if (changed) {
+		RequestScreenRefresh();
 	}
 }
 
@@ -695,11 +971,18 @@ auto CRDFPlugin::TrackAudioStationStatesHandler(const nlohmann::json& data) -> v
 	// deal with all station states and update ES channels
 	// data is json["value"]
 	// frequencies in kHz
+	std::vector<int> activeFrequencies;
 	for (auto& station : data.at("stations")) {
 		if (station.at("type") == "kStationStateUpdate") {
-			TrackAudioStationStateUpdateHandler(station.at("value"));
+			auto& value = station.at("value");
+			TrackAudioStationStateUpdateHandler(value);
+			if (value.value("rx", false) || value.value("tx", false)) {
+				activeFrequencies.push_back(FrequencyFromHz(value.value("frequency", FREQUENCY_REDUNDANT)));
+			}
 		}
 	}
+	// reconcile: channels without an active TrackAudio station are switched off, after the updates above
+	PostStationUpdates(stationUpdates.Reconcile(activeFrequencies, std::chrono::steady_clock::now()));
 }
 
 auto CRDFPlugin::TrackAudioStationStateUpdateHandler(const nlohmann::json& data) -> void
@@ -708,21 +991,84 @@ auto CRDFPlugin::TrackAudioStationStateUpdateHandler(const nlohmann::json& data)
 	// used for update message and for "kStationStates" sections
 	// data is json["value"]
 	// frequencies in kHz
-	if (GetConnectionType() != EuroScopePlugIn::CONNECTION_TYPE_DIRECT)
-		return; // prevent conflict with multiple ES instances. Since AFV hidden window it unique, only disable TrackAudio
 	std::string callsign = data.value("callsign", "");
-	chnl_state state;
+	station_state state;
 	state.frequency = FrequencyFromHz(data.value("frequency", FREQUENCY_REDUNDANT));
 	state.rx = data.value("rx", false);
 	state.tx = data.value("tx", false);
-	UpdateChannel(callsign.size() ? std::optional<std::string>(callsign) : std::nullopt, state);
+	// held until the burst of this station settled, applied on EuroScope thread
+	metrics.stationUpdates.Add();
+	PostStationUpdates(stationUpdates.Push(inline_callsign(callsign), state, std::chrono::steady_clock::now()));
+}
+
+auto CRDFPlugin::PostStationUpdates(const station_push& push) -> void
+{
+	// only the first held update posts, the rest are popped with it or by the timer
+	if (push == STATION_PUSH_SUPERSEDED) {
+		metrics.stationUpdatesSuperseded.Add();
+	}
+	else if (push == STATION_PUSH_FIRST) {
+		if (hiddenWindowRDF == nullptr || !PostMessage(hiddenWindowRDF, WM_RDF_STATIONS, NULL, NULL)) {
+			PLOGW << "unable to post station updates, dropped";
+			stationUpdates.Clear();
+		}
+	}
+}
+
+auto CRDFPlugin::HiddenWndApplyStationStates(void) -> void
+{
+	// runs on EuroScope thread, for WM_RDF_STATIONS and TIMER_RDF_STATIONS
+	KillTimer(hiddenWindowRDF, TIMER_RDF_STATIONS);
+	station_batch due;
+	auto next = stationUpdates.Pop(std::chrono::steady_clock::now(), due);
+	if (next) {
+		auto ms = std::chrono::ceil<std::chrono::milliseconds>(*next).count();
+		SetTimer(hiddenWindowRDF, TIMER_RDF_STATIONS, (UINT)max(ms, 1LL), NULL);
+	}
+	if (GetConnectionType() != EuroScopePlugIn::CONNECTION_TYPE_DIRECT)
+		return; // prevent conflict with multiple ES instances. Since AFV hidden window it unique, only disable TrackAudio
+	for (const auto& update : due.updates) {
+		ApplyStationState(update);
+	}
+	if (due.reconcile) {
+		ReconcileChannels(*due.reconcile);
+	}
+}
+
+auto CRDFPlugin::ReconcileChannels(const std::vector<int>& activeFrequencies) -> void
+{
+	// EuroScope thread, channels without an active TrackAudio station are switched off
+	for (auto chnl = GroundToArChannelSelectFirst(); chnl.IsValid(); chnl = GroundToArChannelSelectNext(chnl)) {
+		int frequency = FrequencyFromMHz(chnl.GetFrequency());
+		if (std::none_of(activeFrequencies.begin(), activeFrequencies.end(), [&](const int& f) { return FrequencyIsSame(f, frequency); })) {
+			if (modeTrackAudio == 2) {
+				stationSync.Remote({ frequency, false, false }, std::chrono::steady_clock::now()); // not a local change
+			}
+			ToggleChannel(chnl, false, false); // check for prim/atis will be done inside
+		}
+	}
+}
+
+auto CRDFPlugin::ApplyStationState(const station_update& update) -> void
+{
+	metrics.stationUpdatesApplied.Add();
+	if (modeTrackAudio == 2 && !stationSync.Remote(update.state, std::chrono::steady_clock::now())) {
+		PLOGD << "echo of station sync: " << update.state.frequency;
+		return;
+	}
+	chnl_state state;
+	state.frequency = update.state.frequency;
+	state.rx = update.state.rx;
+	state.tx = update.state.tx;
+	UpdateChannel(update.callsign.Empty() ? std::nullopt : std::optional<inline_callsign>(update.callsign), state);
 }
 
-auto CRDFPlugin::SelectGroundToAirChannel(const std::optional<std::string>& callsign, const std::optional<int>& frequency) -> EuroScopePlugIn::CGrountToAirChannel
+auto CRDFPlugin::SelectGroundToAirChannel(const std::optional<inline_callsign>& callsign, const std::optional<int>& frequency) -> EuroScopePlugIn::CGrountToAirChannel
 {
+	RDF_TRACE_SCOPE("SelectGroundToAirChannel");
 	if (callsign && frequency) { // find precise match
 		for (auto chnl = GroundToArChannelSelectFirst(); chnl.IsValid(); chnl = GroundToArChannelSelectNext(chnl)) {
-			if (*callsign == chnl.GetName() && FrequencyIsSame(FrequencyFromMHz(chnl.GetFrequency()), *frequency)) {
+			if (*callsign == inline_callsign(chnl.GetName()) && FrequencyIsSame(FrequencyFromMHz(chnl.GetFrequency()), *frequency)) {
 				PLOGD << "precise match is found: " << *callsign << " - " << *frequency;
 				return chnl;
 			}
@@ -730,7 +1076,7 @@ auto CRDFPlugin::SelectGroundToAirChannel(const std::optional<std::string>& call
 	}
 	else if (callsign) { // match callsign only
 		for (auto chnl = GroundToArChannelSelectFirst(); chnl.IsValid(); chnl = GroundToArChannelSelectNext(chnl)) {
-			if (*callsign == chnl.GetName()) {
+			if (*callsign == inline_callsign(chnl.GetName())) {
 				PLOGD << "callsign match is found: " << *callsign << " - " << FrequencyFromMHz(chnl.GetFrequency());
 				return chnl;
 			}
@@ -781,8 +1127,9 @@ auto CRDFPlugin::SelectGroundToAirChannel(const std::optional<std::string>& call
 	return EuroScopePlugIn::CGrountToAirChannel();
 }
 
-auto CRDFPlugin::UpdateChannel(const std::optional<std::string>& callsign, const std::optional<chnl_state>& channelState) -> void
+auto CRDFPlugin::UpdateChannel(const std::optional<inline_callsign>& callsign, const std::optional<chnl_state>& channelState) -> void
 {
+	RDF_TRACE_SCOPE("UpdateChannel");
 	// note: EuroScope channels allow duplication in channel name, but name <-> frequency pair is unique.
 	if (channelState) {
 		if (channelState->isPrim || channelState->isAtis) {
@@ -790,7 +1137,7 @@ auto CRDFPlugin::UpdateChannel(const std::optional<std::string>& callsign, const
 			return;
 		}
 		else {
-			PLOGD << callsign.value_or("NULL") << " - " << channelState->frequency;
+			PLOGD << callsign.value_or(inline_callsign("NULL")) << " - " << channelState->frequency;
 			auto chnl = SelectGroundToAirChannel(callsign, channelState->frequency);
 			if (chnl.IsValid()) {
 				ToggleChannel(chnl, channelState->rx, channelState->tx);
@@ -812,77 +1159,230 @@ auto CRDFPlugin::ToggleChannel(EuroScopePlugIn::CGrountToAirChannel Channel, con
 	}
 	if (rx && *rx != Channel.GetIsTextReceiveOn()) {
 		Channel.ToggleTextReceive();
+		metrics.channelToggles.Add();
 		std::string dmsg = std::format("RX toggle: {} frequency: {} ", Channel.GetName(), std::to_string(Channel.GetFrequency()));
 		PLOGD << dmsg;
 		DisplayDebugMessage(dmsg);
 	}
 	if (tx && *tx != Channel.GetIsTextTransmitOn()) {
 		Channel.ToggleTextTransmit();
+		metrics.channelToggles.Add();
 		std::string dmsg = std::format("TX toggle: {} frequency: {} ", Channel.GetName(), std::to_string(Channel.GetFrequency()));
 		PLOGD << dmsg;
 		DisplayDebugMessage(dmsg);
 	}
 }
 
-auto CRDFPlugin::GetDrawingParam(void) -> draw_settings const
+auto CRDFPlugin::ScreenSettings(const int& screenID) -> std::atomic<std::shared_ptr<const draw_settings>>*
 {
-	draw_settings res;
-	try {
-		std::shared_lock<std::shared_mutex> lock(mtxScreen);
-		res = *setScreen.at(vidScreen);
+	if (screenID < -1 || screenID >= SCREEN_MAX) {
+		return nullptr;
 	}
-	catch (std::exception const& e) {
-		PLOGE << "ID: " << (int)vidScreen << ": " << e.what();
+	return &setScreen[screenID + 1];
+}
+
+auto CRDFPlugin::GetDrawingParam(const int& screenID) -> std::shared_ptr<const draw_settings>
+{
+	// lock free, any thread, screens without own settings use plugin settings
+	if (auto slot = ScreenSettings(screenID)) {
+		if (auto settings = slot->load()) {
+			return settings;
+		}
 	}
-	catch (...) {
-		PLOGE << "ID: " << (int)vidScreen;
+	return setScreen[0].load();
+}
+
+auto CRDFPlugin::UpdateDrawingParam(const int& screenID, const std::function<void(draw_settings&)>& update) -> void
+{
+	// copy, modify and swap, readers keep the settings they loaded
+	auto slot = ScreenSettings(screenID);
+	if (slot == nullptr) {
+		PLOGW << "no settings for screen ID " << screenID << ", limit is " << SCREEN_MAX;
+		return;
+	}
+	std::lock_guard lock(mtxScreen);
+	auto settings = std::make_shared<draw_settings>(*GetDrawingParam(screenID));
+	update(*settings); // nothing is stored if it throws
+	slot->store(std::move(settings));
+}
+
+auto CRDFPlugin::GetDrawGeometry(const int& screenID) -> std::shared_ptr<const draw_geometry>
+{
+	// called on EuroScope thread by every screen, channel states are read before locking
+	auto params = GetDrawingParam(screenID);
+	position_key positionKey = params->PositionKey();
+	bool rxOnly = filterRxOnly;
+	std::vector<int> rxFrequencies;
+	if (rxOnly) {
+		for (auto chnl = GroundToArChannelSelectFirst(); chnl.IsValid(); chnl = GroundToArChannelSelectNext(chnl)) {
+			if (chnl.GetIsTextReceiveOn()) {
+				rxFrequencies.push_back(FrequencyFromMHz(chnl.GetFrequency()));
+			}
+		}
+	}
+	auto isReceived = [&](const int& frequency) -> bool { // unknown frequency is always shown
+		return !rxOnly || !frequency || std::any_of(rxFrequencies.begin(), rxFrequencies.end(), [&](const int& f) { return FrequencyIsSame(f, frequency); });
+		};
+	int showSec = max((int)historyShowSec, 0);
+	auto now = clockTransmission.Now();
+	std::lock_guard glock(mtxGeometry);
+	auto geometry = std::make_shared<draw_geometry>();
+	{
+		auto tlock = TimedLock<std::shared_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+		for (const auto& cached : drawGeometry) {
+			if (cached->positionKey == positionKey && cached->generation == generationTransmission && cached->showSec == showSec &&
+				cached->rxOnly == rxOnly && cached->rxFrequencies == rxFrequencies && (!cached->expires || now < *cached->expires)) {
+				metrics.geometryShared.Add();
+				return cached;
+			}
+		}
+		geometry->build = ++buildGeometry;
+		geometry->generation = generationTransmission;
+		geometry->showSec = showSec;
+		geometry->rxOnly = rxOnly;
+		geometry->rxFrequencies = rxFrequencies;
+		geometry->positionKey = positionKey;
+		TransmissionTable& drawPosition = geometry->rows;
+		if (rxOnly) {
+			// only visits buckets of received frequencies
+			frequencyIndex.ForEach(isReceived, [&](const uint32_t& id) {
+				if (drawPosition.Find(id)) return;
+				if (auto row = curTransmission.Find(id)) {
+					drawPosition.Append(curTransmission, *row);
+				}
+				});
+		}
+		else {
+			drawPosition = curTransmission;
+		}
+		if (showSec > 0) {
+			// history view: current transmissions plus those ended within the window
+			historyTransmission.ForEachSince(now - std::chrono::seconds(showSec), [&](const history_entry& entry) {
+				if (!isReceived(entry.frequency) || drawPosition.Find(entry.id)) return; // newest first, never replaces
+				draw_position dp;
+				dp.sample = entry.sample;
+				dp.frequency = entry.frequency;
+				drawPosition.Set(entry.id, entry.callsign, dp, TX_FLAG_HISTORY | TX_FLAG_DRAWN | (entry.overlapped ? TX_FLAG_OVERLAP : 0)); // not traced
+				auto leaves = entry.end + std::chrono::seconds(showSec);
+				if (!geometry->expires || leaves < *geometry->expires) {
+					geometry->expires = leaves;
+				}
+				});
+		}
+	}
+	// positions with the settings of this screen, then geodesic outlines, outside of transmission lock
+	TransmissionTable& rows = geometry->rows;
+	for (size_t i = rows.Size(); i-- > 0;) { // backwards, swap-remove only moves resolved rows
+		if (!ResolveDrawPosition(rows, i, *params)) {
+			rows.Remove(i);
+		}
+	}
+	geometry->outline.resize(rows.Size() * GEOMETRY_VERTICES);
+	for (size_t i = 0; i < rows.Size(); i++) {
+		EuroScopePlugIn::CPosition position = geometry->Position(i);
+		for (int v = 0; v < GEOMETRY_VERTICES; v++) {
+			EuroScopePlugIn::CPosition& pv = geometry->outline[i * GEOMETRY_VERTICES + v];
+			pv = position;
+			AddOffset(pv, 360.0 * v / GEOMETRY_VERTICES, rows.radius[i]);
+		}
+	}
+	metrics.geometryBuilds.Add();
+	// replaces the previous build for these settings and builds of older generations
+	std::erase_if(drawGeometry, [&](const auto& cached) { return cached->positionKey == positionKey || cached->generation != geometry->generation; });
+	drawGeometry.push_back(geometry);
+	return geometry;
+}
+
+auto CRDFPlugin::MarkDrawn(const draw_geometry& geometry) -> void
+{
+	// records first draw of each transmission, only locks once per geometry with new rows
+	const TransmissionTable& drawPosition = geometry.rows;
+	if (geometry.build == buildMarked) return;
+	buildMarked = geometry.build;
+	if (std::all_of(drawPosition.flags.begin(), drawPosition.flags.end(), [](const uint8_t& f) { return f & TX_FLAG_DRAWN; })) return;
+	auto now = std::chrono::steady_clock::now();
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	for (size_t i = 0; i < drawPosition.Size(); i++) {
+		if (drawPosition.flags[i] & TX_FLAG_DRAWN) continue;
+		auto row = curTransmission.Find(drawPosition.id[i]);
+		// the ID may have been freed and reused since the geometry was built
+		if (!row || curTransmission.callsign[*row] != drawPosition.callsign[i] || curTransmission.flags[*row] & TX_FLAG_DRAWN) continue;
+		curTransmission.flags[*row] |= TX_FLAG_DRAWN;
+		const auto& trace = curTransmission.trace[*row];
+		metrics.rxFirstDraw.Record(now - trace.published);
+		metrics.rxTotal.Record(now - trace.received);
 	}
-	return res;
 }
 
-auto CRDFPlugin::GetDrawStations(void) -> callsign_position
+auto CRDFPlugin::TrackAudioFrameHandler(const std::string& frame, const std::chrono::steady_clock::time_point& received) -> void
 {
-	std::shared_lock tlock(mtxTransmission);
-	return curTransmission.empty() && GetAsyncKeyState(VK_MBUTTON) ? preTransmission : curTransmission;
+	RDF_TRACE_SCOPE("TrackAudioFrameHandler");
+	// dispatches one TrackAudio SDK message, throws on malformed frames
+	rx_trace trace;
+	trace.received = received;
+	auto data = nlohmann::json::parse(frame);
+	std::string msgType = data["type"];
+	nlohmann::json msgValue = data["value"];
+	trace.parsed = std::chrono::steady_clock::now();
+	if (msgType == "kRxBegin") {
+		metrics.wsFrames[WS_FRAME_RX_BEGIN].Add();
+		PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
+		TrackAudioTransmissionHandler(msgValue, false, trace);
+	}
+	else if (msgType == "kRxEnd") {
+		metrics.wsFrames[WS_FRAME_RX_END].Add();
+		PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
+		TrackAudioTransmissionHandler(msgValue, true, trace);
+	}
+	else if (msgType == "kStationStateUpdate" && modeTrackAudio > 0) { // only handle with sync on
+		metrics.wsFrames[WS_FRAME_STATION_STATE_UPDATE].Add();
+		PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
+		TrackAudioStationStateUpdateHandler(msgValue);
+	}
+	else if (msgType == "kStationStates" && modeTrackAudio > 0) {// only handle with sync on
+		metrics.wsFrames[WS_FRAME_STATION_STATES].Add();
+		PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
+		TrackAudioStationStatesHandler(msgValue);
+		if (awaitTrackAudioStates) {
+			awaitTrackAudioStates = false;
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - timeTrackAudioOpen);
+			PLOGI << "TrackAudio is usable " << elapsed.count() << " ms after connection";
+		}
+	}
+	else {
+		metrics.wsFrames[WS_FRAME_OTHER].Add();
+		PLOGV << "WS MSG: " << frame;
+	}
 }
 
 auto CRDFPlugin::TrackAudioMessageHandler(const ix::WebSocketMessagePtr& msg) -> void
 {
+	RDF_TRACE_SCOPE("TrackAudioMessageHandler");
 	try {
 		if (msg->type == ix::WebSocketMessageType::Message) {
-			auto data = nlohmann::json::parse(msg->str);
-			std::string msgType = data["type"];
-			nlohmann::json msgValue = data["value"];
-			if (msgType == "kRxBegin") {
-				PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
-				TrackAudioTransmissionHandler(msgValue, false);
-			}
-			else if (msgType == "kRxEnd") {
-				PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
-				TrackAudioTransmissionHandler(msgValue, true);
-			}
-			else if (msgType == "kStationStateUpdate" && modeTrackAudio > 0) { // only handle with sync on
-				PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
-				TrackAudioStationStateUpdateHandler(msgValue);
-			}
-			else if (msgType == "kStationStates" && modeTrackAudio > 0) {// only handle with sync on
-				PLOGD << "WS MSG" << msgType << ": " << msgValue.dump();
-				TrackAudioStationStatesHandler(msgValue);
+			auto received = std::chrono::steady_clock::now();
+			if (clockTransmission.Replaying()) { // replayed frames are handled on EuroScope thread, see HiddenWndReplayRecords
+				metrics.replayDropped.Add();
 			}
 			else {
-				PLOGV << "WS MSG: " << msg->str;
+				captureWriter.Record(CAPTURE_SOURCE_WS, msg->str);
+				TrackAudioFrameHandler(msg->str, received);
 			}
 		}
 		else if (msg->type == ix::WebSocketMessageType::Open) {
-			// check for TrackAudio presense
-			httplib::Client cli(std::format("http://{}", addressTrackAudio));
-			cli.set_connection_timeout(TRACKAUDIO_TIMEOUT_SEC);
-			if (auto res = cli.Get(TRACKAUDIO_PARAM_VERSION)) {
-				if (res->status == 200 && res->body.size()) {
-					auto imsg = std::format("Connected to {} on {}.", res->body, addressTrackAudio);
-					PLOGI << imsg;
-					DisplayInfoMessage(imsg);
-				}
+			// bring-up: nothing here may block the WS thread
+			timeTrackAudioOpen = std::chrono::steady_clock::now();
+			PLOGD << "TrackAudio WS opened";
+			reconnectTrackAudio.Reset();
+			if (!futureTrackAudioVersion.valid() || futureTrackAudioVersion.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				futureTrackAudioVersion = std::async(std::launch::async, &CRDFPlugin::TrackAudioProbeVersion, this, addressTrackAudio);
+			}
+			if (modeTrackAudio > 0) {
+				awaitTrackAudioStates = true;
+				TrackAudioRequestStationStates();
+			}
+			else {
+				PLOGI << "TrackAudio is usable 0 ms after connection";
 			}
 		}
 		else if (msg->type == ix::WebSocketMessageType::Error) {
@@ -890,6 +1390,24 @@ auto CRDFPlugin::TrackAudioMessageHandler(const ix::WebSocketMessagePtr& msg) ->
 				msg->errorInfo.reason, (int)msg->errorInfo.retries, msg->errorInfo.wait_time, msg->errorInfo.http_status);
 			PLOGD << dmsg;
 			DisplayDebugMessage(dmsg);
+			reconnectTrackAudio.Failed(msg->errorInfo.retries);
+		}
+		else if (msg->type == ix::WebSocketMessageType::Pong) {
+			// heartbeat pong triggers a timestamped ping, whose pong gives the round trip
+			std::string_view payload = msg->str;
+			if (payload.starts_with(TRACKAUDIO_RTT_PING)) {
+				long long sent = 0;
+				payload.remove_prefix(std::string_view(TRACKAUDIO_RTT_PING).size());
+				if (std::from_chars(payload.data(), payload.data() + payload.size(), sent).ec == std::errc()) {
+					auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+					rttTrackAudio = now - sent;
+					PLOGV << "TrackAudio RTT: " << rttTrackAudio.load() << " us";
+				}
+			}
+			else {
+				auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				socketTrackAudio.ping(std::format("{}{}", TRACKAUDIO_RTT_PING, now));
+			}
 		}
 		else if (msg->type == ix::WebSocketMessageType::Close) {
 			auto dmsg = std::format("WS CLOSE! code: {}, reason: {}", (int)msg->closeInfo.code, msg->closeInfo.reason);
@@ -898,7 +1416,44 @@ auto CRDFPlugin::TrackAudioMessageHandler(const ix::WebSocketMessagePtr& msg) ->
 			std::string wmsg = "TrackAudio WebSocket disconnected!";
 			PLOGW << wmsg;
 			DisplayWarnMessage(wmsg);
+			awaitTrackAudioStates = false;
+			rttTrackAudio = -1;
+			stationSync.Clear(); // states are requested again on connection
+			stationUpdates.Clear();
+			ClearTransmissions(); // kRxEnd will not arrive for these
+		}
+	}
+	catch (std::exception const& e) {
+		PLOGE << e.what();
+	}
+	catch (...) {
+		PLOGE << UNKNOWN_ERROR_MSG;
+	}
+}
+
+auto CRDFPlugin::TrackAudioProbeVersion(const std::string address) -> void
+{
+	// runs on its own task, result is cached until endpoint changes
+	try {
+		std::unique_lock vlock(mtxTrackAudioVersion);
+		if (!versionTrackAudio) {
+			vlock.unlock();
+			httplib::Client cli(std::format("http://{}", address));
+			cli.set_connection_timeout(TRACKAUDIO_TIMEOUT_SEC);
+			cli.set_read_timeout(TRACKAUDIO_TIMEOUT_SEC);
+			auto res = cli.Get(TRACKAUDIO_PARAM_VERSION);
+			if (!res || res->status != 200 || !res->body.size()) {
+				PLOGW << "unable to get TrackAudio version on " << address;
+				return;
+			}
+			auto jversion = nlohmann::json::parse(res->body, nullptr, false); // plain text or {"version": ...}
+			vlock.lock();
+			versionTrackAudio = jversion.is_object() && jversion.contains("version") && jversion["version"].is_string() ? jversion["version"].get<std::string>() : res->body;
 		}
+		auto imsg = std::format("Connected to {} on {}.", *versionTrackAudio, address);
+		vlock.unlock();
+		PLOGI << imsg;
+		DisplayInfoMessage(imsg);
 	}
 	catch (std::exception const& e) {
 		PLOGE << e.what();
@@ -908,6 +1463,201 @@ auto CRDFPlugin::TrackAudioMessageHandler(const ix::WebSocketMessagePtr& msg) ->
 	}
 }
 
+auto CRDFPlugin::TrackAudioProbeLiveness(const std::string address) -> bool
+{
+	// runs on its own task while reconnectTrackAudio is probing, the restart is posted to EuroScope thread
+	try {
+		if (ProbeEndpoint(address, TRACKAUDIO_TIMEOUT_SEC)) {
+			if (hiddenWindowRDF != nullptr && PostMessage(hiddenWindowRDF, WM_RDF_RECONNECT, NULL, NULL)) {
+				return true; // HiddenWndReconnectTrackAudio ends the probe
+			}
+			PLOGW << "unable to post TrackAudio reconnection";
+		}
+	}
+	catch (std::exception const& e) {
+		PLOGE << e.what();
+	}
+	catch (...) {
+		PLOGE << UNKNOWN_ERROR_MSG;
+	}
+	return false;
+}
+
+auto CRDFPlugin::HiddenWndReconnectTrackAudio(void) -> void
+{
+	// runs on EuroScope thread like LoadTrackAudioSettings, restarts WS immediately instead of waiting for backoff
+	if (reconnectTrackAudio.Restart(modeTrackAudio != -1 && socketTrackAudio.getReadyState() == ix::ReadyState::Closed)) {
+		PLOGI << "TrackAudio endpoint is back, reconnecting";
+	}
+}
+
+auto CRDFPlugin::TrackAudioRequestStationStates(void) -> void
+{
+	nlohmann::json jmsg;
+	jmsg["type"] = "kGetStationStates";
+	socketTrackAudio.send(jmsg.dump());
+	PLOGD << "kGetStationStates is sent via WS";
+}
+
+auto CRDFPlugin::TrackAudioSyncStations(void) -> void
+{
+	// pushes settled EuroScope text channel changes to TrackAudio, one command per station
+	if (GetConnectionType() != EuroScopePlugIn::CONNECTION_TYPE_DIRECT || socketTrackAudio.getReadyState() != ix::ReadyState::Open)
+		return; // same guard as TrackAudio -> EuroScope
+	std::vector<station_state> channels;
+	for (auto chnl = GroundToArChannelSelectFirst(); chnl.IsValid(); chnl = GroundToArChannelSelectNext(chnl)) {
+		int frequency = FrequencyFromMHz(chnl.GetFrequency());
+		if (chnl.GetIsPrimary() || chnl.GetIsAtis() || FrequencyIsSame(frequency, FREQUENCY_REDUNDANT)) continue; // never synced
+		channels.push_back({ frequency, chnl.GetIsTextReceiveOn(), chnl.GetIsTextTransmitOn() });
+	}
+	auto now = std::chrono::steady_clock::now();
+	stationSync.Observe(channels, now);
+	for (const auto& station : stationSync.Flush(now)) {
+		nlohmann::json jmsg;
+		jmsg["type"] = "kSetStationState";
+		jmsg["value"]["frequency"] = station.frequency * 1000; // Hz
+		jmsg["value"]["rx"] = station.rx;
+		jmsg["value"]["tx"] = station.tx;
+		socketTrackAudio.send(jmsg.dump());
+		PLOGD << "kSetStationState is sent via WS: " << jmsg["value"].dump();
+	}
+}
+
+auto CRDFPlugin::StartReplay(const std::filesystem::path& path, const double& speed) -> void
+{
+	// runs on EuroScope thread, transmission paths run on the capture times, starting from a clean state
+	CaptureReader reader;
+	if (!reader.Open(path)) {
+		auto wmsg = std::format("Unable to open capture {}", path.string());
+		PLOGW << wmsg;
+		DisplayWarnMessage(wmsg);
+		return;
+	}
+	uint64_t span = reader.Span();
+	captureWriter.Suppress(true);
+	startReplay = std::chrono::steady_clock::now();
+	baseReplay = ReplayClock::Base(startReplay, span, speed);
+	countReplay = 0;
+	nameReplay = path.filename().string();
+	std::unique_lock qlock(mtxReplay);
+	queueReplay.clear();
+	endReplay = false;
+	qlock.unlock();
+	auto tlock = TimedLock<std::unique_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+	ResetTransmissions();
+	clockTransmission.Begin(baseReplay);
+	expiryTransmission.Restart(ExpiryTick(baseReplay));
+	auto tags = CollectTagIndex();
+	tlock.unlock();
+	PublishTagIndex(tags);
+	RequestScreenRefresh();
+	activeReplay = true;
+	threadReplay = std::jthread(std::bind_front(&CRDFPlugin::ReplayCapture, this), std::move(reader), speed);
+}
+
+auto CRDFPlugin::StopReplay(const bool& display) -> void
+{
+	// runs on EuroScope thread, after the last record or on .RDF REPLAY STOP
+	if (threadReplay.joinable()) {
+		threadReplay.request_stop();
+		threadReplay.join();
+	}
+	if (!activeReplay) return;
+	activeReplay = false;
+	std::unique_lock qlock(mtxReplay);
+	queueReplay.clear();
+	endReplay = false;
+	qlock.unlock();
+	clockTransmission.End();
+	captureWriter.Suppress(false);
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startReplay);
+	auto imsg = std::format("Replayed {} records of {} in {} ms", countReplay, nameReplay, elapsed.count());
+	PLOGI << imsg;
+	if (display) {
+		DisplayInfoMessage(imsg);
+	}
+	if (modeTrackAudio > 0 && socketTrackAudio.getReadyState() == ix::ReadyState::Open) {
+		TrackAudioRequestStationStates(); // live station updates were dropped while replaying
+	}
+}
+
+auto CRDFPlugin::ReplayCapture(std::stop_token stop, CaptureReader reader, const double speed) -> void
+{
+	// records are paced by speed, speed <= 0 replays as fast as EuroScope thread takes them
+	// queueReplay is bounded, the first record into an empty queue posts WM_RDF_REPLAY
+	auto PostRecords = [&](void) {
+		if (hiddenWindowRDF == nullptr || !PostMessage(hiddenWindowRDF, WM_RDF_REPLAY, NULL, NULL)) {
+			PLOGW << "unable to post replayed records, left to timer";
+		}
+		};
+	auto wallStart = std::chrono::steady_clock::now();
+	std::mutex mtxSleep;
+	std::condition_variable_any cvSleep;
+	capture_record record;
+	std::optional<uint64_t> timeFirst;
+	while (!stop.stop_requested() && reader.Next(record)) {
+		if (!timeFirst) {
+			timeFirst = record.time;
+		}
+		record.time -= *timeFirst;
+		if (speed > 0) {
+			auto due = wallStart + std::chrono::microseconds((long long)(record.time / speed));
+			std::unique_lock lock(mtxSleep);
+			cvSleep.wait_until(lock, stop, due, [] { return false; });
+			if (stop.stop_requested()) return;
+		}
+		std::unique_lock lock(mtxReplay);
+		if (!cvReplay.wait(lock, stop, [&] { return queueReplay.size() < REPLAY_QUEUE_CAPACITY; })) return;
+		bool first = queueReplay.empty();
+		queueReplay.push_back(std::move(record));
+		lock.unlock();
+		if (first) {
+			PostRecords();
+		}
+	}
+	if (stop.stop_requested()) return; // StopReplay ends the replay
+	std::unique_lock lock(mtxReplay);
+	endReplay = true;
+	bool first = queueReplay.empty();
+	lock.unlock();
+	if (first) {
+		PostRecords();
+	}
+}
+
+auto CRDFPlugin::HiddenWndReplayRecords(void) -> void
+{
+	// runs on EuroScope thread, for WM_RDF_REPLAY and OnTimer, records take the same paths as live ones
+	if (!activeReplay) return;
+	std::deque<capture_record> due;
+	std::unique_lock qlock(mtxReplay);
+	due.swap(queueReplay);
+	bool ended = endReplay;
+	qlock.unlock();
+	cvReplay.notify_one();
+	for (const auto& record : due) {
+		clockTransmission.Set(baseReplay + std::chrono::microseconds(record.time));
+		try {
+			if (record.source == CAPTURE_SOURCE_WS) {
+				TrackAudioFrameHandler(record.payload);
+			}
+			else if (record.source == CAPTURE_SOURCE_RDF) {
+				HiddenWndProcessRDFMessage(record.payload.c_str(), true); // up to first NUL, as WM_COPYDATA
+			}
+			else {
+				HiddenWndProcessAFVMessage(record.payload.c_str(), true);
+			}
+		}
+		catch (std::exception const& e) {
+			PLOGE << e.what();
+		}
+		countReplay++;
+	}
+	if (ended) {
+		StopReplay(true);
+	}
+}
+
 auto CRDFPlugin::OnRadarScreenCreated(const char* sDisplayName,
 	bool NeedRadarContent,
 	bool GeoReferenced,
@@ -915,14 +1665,26 @@ auto CRDFPlugin::OnRadarScreenCreated(const char* sDisplayName,
 	bool CanBeCreated)
 	-> EuroScopePlugIn::CRadarScreen*
 {
-	size_t i = vecScreen.size(); // should not be -1
 	auto imsg = std::format("RDF plugin is activated on {}.", sDisplayName);
 	PLOGI << imsg;
 	DisplayInfoMessage(imsg);
-	std::shared_ptr<CRDFScreen> screen = std::make_shared<CRDFScreen>(i);
-	vecScreen.push_back(screen);
-	PLOGD << "screen created, id " << i;
-	return screen.get();
+	auto screen = screens.Open([](const screen_handle& handle) { return new CRDFScreen(handle); }); // deletes itself in OnAsrContentToBeClosed
+	PLOGD << "screen created, id " << screen->m_Handle.id << ", generation " << screen->m_Handle.generation;
+	return screen;
+}
+
+auto CRDFPlugin::CloseScreen(const screen_handle& screen) -> void
+{
+	// called from OnAsrContentToBeClosed, the screen deletes itself right after
+	if (!screens.Close(screen)) {
+		PLOGW << "screen " << screen.id << " already closed";
+		return;
+	}
+	if (auto slot = ScreenSettings(screen.id)) {
+		std::lock_guard lock(mtxScreen);
+		slot->store(nullptr); // next screen in this slot starts from plugin settings
+	}
+	PLOGD << "screen closed, id " << screen.id << ", generation " << screen.generation;
 }
 
 auto CRDFPlugin::OnCompileCommand(const char* sCommandLine) -> bool
@@ -936,29 +1698,140 @@ auto CRDFPlugin::OnCompileCommand(const char* sCommandLine) -> bool
 		if (std::regex_match(cmd, match, rxReload)) {
 			LoadTrackAudioSettings();
 			{
-				std::unique_lock lock(mtxScreen); // cautious for overlapped lock
-				setScreen.clear();
-				setScreen[-1] = std::make_shared<draw_settings>(); // initialize default settings
+				std::lock_guard lock(mtxScreen); // cautious for overlapped lock
+				for (auto& slot : setScreen) {
+					slot.store(nullptr);
+				}
+				setScreen[0] = std::make_shared<const draw_settings>(); // initialize default settings
 			}
-			LoadDrawingSettings(-1); // restore plugin settings
-			for (auto& s : vecScreen) { // reload asr settings
-				s->newAsrData.clear();
-				LoadDrawingSettings(s->m_ID);
+			LoadDrawingSettings(); // restore plugin settings
+			screens.ForEach([&](CRDFScreen& s) { // reload asr settings
+				s.newAsrData.clear();
+				LoadDrawingSettings(s.m_Handle);
+				});
+			return true;
+		}
+		std::regex rxCapture(R"(^.RDF CAPTURE (START|STOP)$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxCapture)) {
+			captureWriter.Stop();
+			std::string action = match[1].str();
+			std::transform(action.begin(), action.end(), action.begin(), ::toupper);
+			if (action == "START") {
+				auto path = pathPlugin / std::format("RDFCapture_{:%Y%m%d_%H%M%S}.bin", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+				if (captureWriter.Start(path)) {
+					auto imsg = std::format("Capturing to {}", path.filename().string());
+					PLOGI << imsg;
+					DisplayInfoMessage(imsg);
+				}
+				else {
+					DisplayWarnMessage("Unable to start capture");
+				}
+			}
+			else {
+				PLOGI << "capture stopped";
+				DisplayInfoMessage("Capture stopped");
+			}
+			return true;
+		}
+		std::regex rxTrace(R"(^.RDF TRACE (START|STOP)$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxTrace)) {
+#ifdef RDF_TRACE
+			std::string action = match[1].str();
+			std::transform(action.begin(), action.end(), action.begin(), ::toupper);
+			if (action == "START") {
+				Tracer().Start();
+				PLOGI << "trace started";
+				DisplayInfoMessage("Trace started");
+			}
+			else if (Tracer().IsActive()) {
+				auto path = pathPlugin / std::format("RDFTrace_{:%Y%m%d_%H%M%S}.json", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+				uint64_t dropped = 0;
+				size_t spans = Tracer().Stop(path, dropped);
+				auto imsg = std::format("Trace written to {}, {} spans, {} dropped", path.filename().string(), spans, dropped);
+				PLOGI << imsg;
+				DisplayInfoMessage(imsg);
+			}
+#else
+			DisplayWarnMessage("Tracing is not compiled in, build with RDF_TRACE defined");
+#endif // RDF_TRACE
+			return true;
+		}
+		std::regex rxReplay(R"(^.RDF REPLAY (\S+)(?: (\S+))?$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxReplay)) { // .RDF REPLAY <file> [speed|MAX], or .RDF REPLAY STOP
+			StopReplay(true);
+			std::string file = match[1].str();
+			std::string speedText = match[2].matched ? match[2].str() : "1";
+			std::transform(speedText.begin(), speedText.end(), speedText.begin(), ::toupper);
+			if (_stricmp(file.c_str(), "STOP") != 0) {
+				double speed = speedText == "MAX" ? 0.0 : std::stod(speedText);
+				std::filesystem::path path = file;
+				if (path.is_relative()) {
+					path = pathPlugin / path;
+				}
+				PLOGI << "replaying " << path.string() << " at speed " << speedText;
+				StartReplay(path, speed);
 			}
 			return true;
 		}
+		std::regex rxStats(R"(^.RDF STATS( RESET)?$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxStats)) {
+			ReportMetrics(true);
+			if (match[1].matched) {
+				metrics.Reset();
+				std::unique_lock tlock(mtxTransmission);
+				overlapsFrequency.clear();
+				tlock.unlock();
+				screens.ForEach([](CRDFScreen& s) {
+					for (auto& h : s.refreshDuration) {
+						h.Reset();
+					}
+					s.frameBudget.Reset();
+					s.layerCache.Reset();
+					});
+				stationSync.Reset();
+			}
+			return true;
+		}
+		std::regex rxHistory(R"(^.RDF HISTORY(?: (\d+|OFF))?$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxHistory)) { // toggle, or set window in seconds, or OFF
+			int showSec = 0;
+			if (!match[1].matched) {
+				showSec = historyShowSec > 0 ? 0 : HISTORY_DEFAULT_SEC;
+			}
+			else if (std::isdigit((unsigned char)match[1].str()[0])) {
+				showSec = std::stoi(match[1].str());
+			}
+			historyShowSec = showSec;
+			auto imsg = showSec > 0 ? std::format("Showing transmissions of last {} s", showSec) : std::string("History hidden");
+			PLOGI << imsg;
+			DisplayInfoMessage(imsg);
+			RequestScreenRefresh();
+			return true;
+		}
+		std::regex rxRxOnly(R"(^.RDF RXONLY(?: (ON|OFF))?$)", std::regex_constants::icase);
+		if (std::regex_match(cmd, match, rxRxOnly)) { // toggle, or ON/OFF
+			bool rxOnly = !filterRxOnly;
+			if (match[1].matched) {
+				rxOnly = toupper(match[1].str()[1]) == 'N';
+			}
+			filterRxOnly = rxOnly;
+			auto imsg = rxOnly ? std::string("Showing transmissions on RX frequencies only") : std::string("Showing transmissions on all frequencies");
+			PLOGI << imsg;
+			DisplayInfoMessage(imsg);
+			RequestScreenRefresh();
+			return true;
+		}
 		std::regex rxRefresh(R"(^.RDF REFRESH$)", std::regex_constants::icase);
 		if (std::regex_match(cmd, match, rxRefresh)) {
 			PLOGD << "refreshing RDF records and station states";
 			std::unique_lock tlock(mtxTransmission);
-			curTransmission.clear();
-			preTransmission.clear();
+			ResetTransmissions();
+			auto tags = CollectTagIndex();
 			tlock.unlock();
+			PublishTagIndex(tags);
+			RequestScreenRefresh();
 			UpdateChannel(std::nullopt, std::nullopt); // deactivate all channels;
-			nlohmann::json jmsg;
-			jmsg["type"] = "kGetStationStates";
-			socketTrackAudio.send(jmsg.dump());
-			PLOGD << "kGetStationStates is sent via WS";
+			TrackAudioRequestStationStates();
 			return true;
 		}
 		return ProcessDrawingCommand(sCommandLine);
@@ -976,13 +1849,118 @@ auto CRDFPlugin::OnCompileCommand(const char* sCommandLine) -> bool
 	return false;
 }
 
+auto CRDFPlugin::ReportMetrics(const bool& display) -> void
+{
+	// display = true prints to chat, otherwise to log only
+	auto elapsed = std::chrono::steady_clock::now() - metrics.timeReset;
+	double elapsedNs = (double)max(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), 1LL);
+	std::vector<std::string> lines;
+	std::string frames;
+	for (size_t i = 0; i < WS_FRAME_TYPES; i++) {
+		frames += std::format("{}{} {}", i ? ", " : "", WS_FRAME_NAMES[i], metrics.wsFrames[i].Get());
+	}
+	lines.push_back(std::format("Stats over {} s", std::chrono::duration_cast<std::chrono::seconds>(elapsed).count()));
+	lines.push_back("WS frames: " + frames);
+	lines.push_back(std::format("AFV messages: RDF {}, bridge {}", metrics.afvRDFMessages.Get(), metrics.afvBridgeMessages.Get()));
+	lines.push_back(std::format("Live messages dropped while replaying: {}", metrics.replayDropped.Get()));
+	lines.push_back(std::format("Draw positions: {} generated, {} unresolved", metrics.drawPositionCalls.Get(), metrics.drawPositionFailures.Get()));
+	lines.push_back(std::format("Channel toggles: {}, tag items: {}", metrics.channelToggles.Get(), metrics.tagItemCalls.Get()));
+	lines.push_back(std::format("Station updates: {} received, {} superseded, {} applied",
+		metrics.stationUpdates.Get(), metrics.stationUpdatesSuperseded.Get(), metrics.stationUpdatesApplied.Get()));
+	if (modeTrackAudio == 2) {
+		lines.push_back("Station sync: " + stationSync.Summary());
+	}
+	lines.push_back("Lock wait transmission: " + metrics.waitTransmission.Summary());
+	uint64_t refreshNs = 0;
+	lines.push_back("Screens: " + screens.Summary());
+	screens.ForEach([&](CRDFScreen& screen) {
+		if (!screen.m_Opened) return;
+		for (size_t phase = 0; phase < screen.refreshDuration.size(); phase++) {
+			const auto& h = screen.refreshDuration[phase];
+			refreshNs += h.Sum();
+			if (h.Count()) {
+				lines.push_back(std::format("Refresh screen {} phase {}: {}", screen.m_Handle.id, phase, h.Summary()));
+			}
+		}
+		lines.push_back(std::format("LOD screen {}: {}", screen.m_Handle.id, screen.frameBudget.Summary()));
+		lines.push_back(std::format("Layer screen {}: {}", screen.m_Handle.id, screen.layerCache.Summary()));
+		});
+	lines.push_back(std::format("Transmissions expired: {}", metrics.transmissionsExpired.Get()));
+	lines.push_back(std::format("Draw geometry: {} builds, {} shared", metrics.geometryBuilds.Get(), metrics.geometryShared.Get()));
+	std::string overlaps;
+	{
+		auto tlock = TimedLock<std::shared_lock<std::shared_mutex>>(mtxTransmission, metrics.waitTransmission);
+		for (const auto& [frequency, count] : overlapsFrequency) {
+			overlaps += std::format(", {} {}", frequency ? std::format("{:.3f}", frequency / 1000.0) : std::string("unknown"), count);
+		}
+	}
+	lines.push_back(std::format("Transmission overlaps: {}{}", metrics.transmissionOverlaps.Get(), overlaps));
+	lines.push_back(std::format("Log records dropped: {}", logAppender->Dropped()));
+	lines.push_back(std::format("Screen refresh requests: {}, posted: {}", metrics.refreshRequests.Get(), metrics.refreshPosted.Get()));
+	lines.push_back("RX parse: " + metrics.rxParse.Summary());
+	lines.push_back("RX position: " + metrics.rxPosition.Summary());
+	lines.push_back("RX publish: " + metrics.rxPublish.Summary());
+	lines.push_back("RX wait for first draw: " + metrics.rxFirstDraw.Summary());
+	lines.push_back("RX message to screen: " + metrics.rxTotal.Summary());
+	lines.push_back(std::format("Refresh share of wall time: {:.3f}%", refreshNs / elapsedNs * 100.0));
+	if (rttTrackAudio >= 0) {
+		lines.push_back(std::format("TrackAudio RTT: {:.1f} ms", rttTrackAudio / 1000.0));
+	}
+	for (const auto& line : lines) {
+		PLOGI << line;
+		if (display) {
+			DisplayInfoMessage(line);
+		}
+	}
+}
+
+auto CRDFPlugin::OnTimer(int Counter) -> void
+{
+	if (Counter % METRICS_LOG_INTERVAL_SEC == 0) {
+		ReportMetrics(false);
+	}
+	ExpireTransmissions();
+	HiddenWndReplayRecords(); // in case WM_RDF_REPLAY could not be posted
+	if (modeTrackAudio == 2) {
+		TrackAudioSyncStations();
+	}
+	// liveness probe is only worth it while ixwebsocket sleeps longer than the probe interval, one at a time
+	reconnectTrackAudio.Tick(modeTrackAudio != -1 && socketTrackAudio.getReadyState() == ix::ReadyState::Closed,
+		std::bind_front(&CRDFPlugin::TrackAudioProbeLiveness, this, addressTrackAudio));
+}
+
 auto CRDFPlugin::OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, EuroScopePlugIn::CRadarTarget RadarTarget, int ItemCode, int TagData, char sItemString[16], int* pColorCode, COLORREF* pRGB, double* pFontSize) -> void
 {
-	if (!FlightPlan.IsValid() || ItemCode != TAG_ITEM_TYPE_RDF_STATE) return;
-	std::string callsign = FlightPlan.GetCallsign();
-	std::shared_lock tlock(mtxTransmission);
-	if (preTransmission.contains(callsign)) {
-		strcpy_s(sItemString, 2, "!");
+	if (ItemCode < TAG_ITEM_TYPE_RDF_STATE || ItemCode > TAG_ITEM_TYPE_RDF_TX_COUNT || !FlightPlan.IsValid()) return;
+	metrics.tagItemCalls.Add();
+	// called per tag per refresh, lookup is lock and allocation free
+	auto state = tagIndex.Find(FlightPlan.GetCallsign());
+	if (!state) return;
+	long long age = state->lastEnd ? std::chrono::duration_cast<std::chrono::seconds>(clockTransmission.Now() - *state->lastEnd).count() : -1;
+	switch (ItemCode) {
+	case TAG_ITEM_TYPE_RDF_STATE: // "!" while transmitting, then seconds since end within HISTORY_DEFAULT_SEC
+		if (state->transmitting) {
+			strcpy_s(sItemString, 2, "!");
+		}
+		else if (age >= 0 && age < HISTORY_DEFAULT_SEC) {
+			sprintf_s(sItemString, 16, "%llds", age);
+		}
+		break;
+	case TAG_ITEM_TYPE_RDF_TRANSMITTING:
+		if (state->transmitting) {
+			strcpy_s(sItemString, 2, "!");
+		}
+		break;
+	case TAG_ITEM_TYPE_RDF_LAST_TX:
+		if (age >= 0) {
+			sprintf_s(sItemString, 16, "%llds", age);
+		}
+		break;
+	case TAG_ITEM_TYPE_RDF_TX_COUNT:
+		if (state->count) {
+			sprintf_s(sItemString, 16, "%u", state->count);
+		}
+		break;
 	}
 }
 
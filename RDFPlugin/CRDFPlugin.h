@@ -4,22 +4,47 @@
 #include "HiddenWindow.h"
 #include "CRDFScreen.h"
 #include "RDFStyles.h"
+#include "RDFCapture.h"
+#include "RDFMetrics.h"
+#include "RDFCallsign.h"
+#include "RDFTransmissionTable.h"
+#include "RDFGeometry.h"
+#include "RDFLogAppender.h"
+#include "RDFTrace.h"
+#include "RDFTimerWheel.h"
+#include "RDFHistory.h"
+#include "RDFTagIndex.h"
+#include "RDFScreenRegistry.h"
+#include "RDFStationSync.h"
+#include "RDFStationQueue.h"
+#include "RDFReconnect.h"
+#include "RDFReconnectProbe.h"
 #include <memory>
 
 // Plugin info
 constexpr auto MY_PLUGIN_NAME = "RDF Plugin for Euroscope";
 constexpr auto MY_PLUGIN_VERSION = "1.4.1";
-constexpr auto MY_PLUGIN_DEVELOPER = "Kingfu Chan, modified by Ben Bckmann";
-constexpr auto MY_PLUGIN_COPYRIGHT = "GPLv3 License, Copyright (c) 2023 Kingfu Chan, modifications Copyright (c) 2025 Ben Bckmann";
+constexpr auto MY_PLUGIN_DEVELOPER = "Kingfu Chan, modified by Ben Böckmann";
+constexpr auto MY_PLUGIN_COPYRIGHT = "GPLv3 License, Copyright (c) 2023 Kingfu Chan, modifications Copyright (c) 2025 Ben Böckmann";
 // TrackAudio URLs and parameters
 constexpr auto TRACKAUDIO_PARAM_VERSION = "/*";
 constexpr auto TRACKAUDIO_PARAM_WS = "/ws";
 constexpr auto TRACKAUDIO_TIMEOUT_SEC = 1;
 constexpr auto TRACKAUDIO_HEARTBEAT_SEC = 30;
+constexpr auto TRACKAUDIO_RTT_PING = "rdf::rtt::"; // ping payload prefix, followed by send time in us
+constexpr UINT WM_RDF_REFRESH = WM_APP + 1; // posted to HiddenWindowRDF, redraws screens on EuroScope thread
+constexpr UINT WM_RDF_STATIONS = WM_APP + 2; // posted to HiddenWindowRDF, applies held station updates on EuroScope thread
+constexpr UINT WM_RDF_RECONNECT = WM_APP + 3; // posted to HiddenWindowRDF, TrackAudio endpoint answered the liveness probe
+constexpr UINT WM_RDF_REPLAY = WM_APP + 4; // posted to HiddenWindowRDF, replayed records are due on EuroScope thread
+constexpr size_t REPLAY_QUEUE_CAPACITY = 256; // records paced ahead of EuroScope thread
+constexpr UINT_PTR TIMER_RDF_STATIONS = 1; // HiddenWindowRDF timer, next held station update is due
+constexpr int SCREEN_MAX = 64; // open screens with own drawing settings, further screens use plugin settings
 // Global settings
 constexpr auto SETTING_LOG_LEVEL = "LogLevel"; // see plog::Severity
 constexpr auto SETTING_ENDPOINT = "Endpoint";
 constexpr auto SETTING_HELPER_MODE = "TrackAudioMode"; // Default: 1 (station sync TA -> RDF)
+constexpr auto SETTING_MAX_TRANSMISSION = "MaxTransmission"; // seconds, Default: 60, 0 to disable expiry
+constexpr auto SETTING_FRAME_BUDGET = "FrameBudget"; // microseconds per frame for RDF drawing, Default: 2000, 0 to disable LOD
 // Shared settings (ASR specific)
 constexpr auto SETTING_RGB = "RGB";
 constexpr auto SETTING_CONCURRENT_RGB = "ConcurrentTransmissionRGB";
@@ -33,6 +58,9 @@ constexpr auto SETTING_HIGH_PRECISION = "HighPrecision";
 constexpr auto SETTING_DRAW_CONTROLLERS = "DrawControllers";
 // Tag item type
 const int TAG_ITEM_TYPE_RDF_STATE = 1001; // RDF state
+const int TAG_ITEM_TYPE_RDF_TRANSMITTING = 1002; // RDF transmitting
+const int TAG_ITEM_TYPE_RDF_LAST_TX = 1003; // RDF last TX
+const int TAG_ITEM_TYPE_RDF_TX_COUNT = 1004; // RDF TX count
 
 // Styles
 constexpr auto SETTING_STYLE = "Style";
@@ -55,23 +83,42 @@ inline static auto FrequencyFromHz(const double& freq) -> int {
 inline static auto FrequencyIsSame(const auto& freq1, const auto& freq2) -> bool { // return true if same frequency, frequency in kHz
 	return abs(freq1 - freq2) <= 10;
 }
+inline static auto FrequencyFromMHz(const std::string_view& freq) -> std::optional<int> { // "xxx.xxx" in MHz to kHz, without floating point
+	auto dot = freq.find('.');
+	auto intPart = freq.substr(0, dot);
+	int mhz = 0;
+	auto [pInt, ecInt] = std::from_chars(intPart.data(), intPart.data() + intPart.size(), mhz);
+	if (ecInt != std::errc() || pInt != intPart.data() + intPart.size()) return std::nullopt;
+	int khz = 0;
+	if (dot != std::string_view::npos) {
+		auto fracPart = freq.substr(dot + 1);
+		for (size_t i = 0; i < fracPart.size(); i++) {
+			if (fracPart[i] < '0' || fracPart[i] > '9') return std::nullopt;
+			if (i < 3) {
+				khz = khz * 10 + (fracPart[i] - '0');
+			}
+			else if (i == 3 && fracPart[i] >= '5') {
+				khz++; // round half up as FrequencyFromMHz(double)
+			}
+		}
+		for (size_t i = fracPart.size(); i < 3; i++) {
+			khz *= 10;
+		}
+	}
+	return mhz * 1000 + khz;
+}
+inline static auto ForEachToken(const std::string_view& str, const char& delim, const auto& func) -> void { // func(std::string_view), no copy
+	size_t begin = 0;
+	while (begin <= str.size()) {
+		size_t end = str.find(delim, begin);
+		if (end == std::string_view::npos) {
+			end = str.size();
+		}
+		func(str.substr(begin, end - begin));
+		begin = end + 1;
+	}
+}
 
-// Draw position
-typedef struct _draw_position {
-	EuroScopePlugIn::CPosition position;
-	double radius;
-	_draw_position(void) :
-		position(),
-		radius(0) // invalid value
-	{
-	};
-	_draw_position(EuroScopePlugIn::CPosition _position, double _radius) :
-		position(_position),
-		radius(_radius)
-	{
-	};
-} draw_position;
-typedef std::map<std::string, draw_position> callsign_position;
 auto AddOffset(EuroScopePlugIn::CPosition& position, const double& heading, const double& distance) -> void;
 
 // Draw settings
@@ -86,6 +133,7 @@ typedef struct _draw_settings {
 	int lowPrecision;
 	int highPrecision;
 	bool drawController;
+	int clusterOverlap; // percent, see CircleClusterer
 
 	_draw_settings(void) {
 		// Initialize with zeros/nulls since real defaults will come from config
@@ -99,13 +147,19 @@ typedef struct _draw_settings {
 		highAltitude = 0;
 		highPrecision = 0;
 		drawController = false;
+		clusterOverlap = CLUSTER_OVERLAP_DEFAULT;
+	};
+
+	// settings that resolve a position_sample, see ResolveDrawPosition
+	auto PositionKey(void) const -> position_key {
+		return { circleRadius, circlePrecision, circleThreshold, lowAltitude, highAltitude, lowPrecision, highPrecision, drawController };
 	};
 } draw_settings;
 
 
 // Frequency & channel state
 typedef struct _freq_state {
-	std::optional<std::string> callsign; // can be empty
+	std::optional<inline_callsign> callsign; // can be empty
 	bool tx = false;
 } freq_state;
 typedef struct _es_chnl_state {
@@ -138,26 +192,67 @@ private:
 	std::unique_ptr<StyleManager> styleManager;
 
 	// screen controls and drawing params
-	std::vector<std::shared_ptr<CRDFScreen>> vecScreen; // index is screen ID (incremental int)
-	std::map<int, std::shared_ptr<draw_settings>> setScreen; // screeID -> settings, ID=-1 used as plugin setting
-	std::atomic_int vidScreen;
-	std::shared_mutex mtxScreen;
-	auto GetDrawingParam(void) -> draw_settings const;
+	ScreenRegistry<CRDFScreen> screens; // EuroScope thread only, screen ID is the slot
+	auto CloseScreen(const screen_handle& screen) -> void;
+	// immutable settings per screen, swapped on change so readers never lock
+	std::array<std::atomic<std::shared_ptr<const draw_settings>>, SCREEN_MAX + 1> setScreen; // index is screen ID + 1, 0 is plugin setting, null uses plugin setting
+	std::mutex mtxScreen; // serializes writers of setScreen only
+	auto ScreenSettings(const int& screenID) -> std::atomic<std::shared_ptr<const draw_settings>>*; // nullptr if out of range
+	auto GetDrawingParam(const int& screenID) -> std::shared_ptr<const draw_settings>;
+	auto UpdateDrawingParam(const int& screenID, const std::function<void(draw_settings&)>& update) -> void; // copy-on-write
+	auto ApplyStyle(draw_settings& settings, const rdf_style& style) -> void;
 
 	// drawing records
 	std::shared_mutex mtxTransmission;
-	callsign_position curTransmission;
-	callsign_position preTransmission;
+	TransmissionTable curTransmission; // one row per callsign
+	FrequencyIndex frequencyIndex; // (callsign ID, frequency) receptions of curTransmission
+	std::atomic_bool filterRxOnly = false; // .RDF RXONLY, draw only frequencies with RX on
+	std::map<int, uint64_t> overlapsFrequency; // kHz -> overlaps since STATS RESET, under mtxTransmission
+	auto AddReception(const size_t& row, const int& frequency) -> bool; // needs unique lock on mtxTransmission
+	uint64_t generationTransmission = 1; // under mtxTransmission, bumped when drawn rows change
+	std::mutex mtxGeometry;
+	std::vector<std::shared_ptr<const draw_geometry>> drawGeometry; // under mtxGeometry, one per position_key in use
+	uint64_t buildGeometry = 0; // under mtxGeometry
+	uint64_t buildMarked = 0; // EuroScope thread, last geometry recorded by MarkDrawn
+	CallsignInterner callsignIds; // under mtxTransmission, declared before its holders
+	TransmissionHistory historyTransmission{ callsignIds };
+	std::atomic_int historyShowSec = 0; // .RDF HISTORY window, 0 for off
+	TagIndex tagIndex; // read by OnGetTagItem without lock
+	uint64_t sequenceTagIndex = 0; // under mtxTransmission
+	auto CollectTagIndex(void) -> tag_snapshot; // needs unique lock on mtxTransmission
+	auto PublishTagIndex(const tag_snapshot& snapshot) -> void; // after releasing mtxTransmission
+	TimerWheel<uint32_t> expiryTransmission; // callsign IDs, under mtxTransmission, 1 s ticks
+	std::atomic_int maxTransmissionSec;
+	std::atomic_int frameBudgetUs; // SETTING_FRAME_BUDGET
 
 	// TrackAudio WebSocket
 	std::atomic_int modeTrackAudio; // -1: no RDF, 0: no station sync, 1: station sync TA -> RDF, 2: station sync TA <-> RDF
 	std::string addressTrackAudio;
 	ix::WebSocket socketTrackAudio;
+	std::future<void> futureTrackAudioVersion; // version probe, never runs on WS thread
+	std::mutex mtxTrackAudioVersion;
+	std::optional<std::string> versionTrackAudio; // cached version of current endpoint
+	std::chrono::steady_clock::time_point timeTrackAudioOpen;
+	bool awaitTrackAudioStates = false; // WS thread only
+	ReconnectDriver<ix::WebSocket> reconnectTrackAudio{ socketTrackAudio }; // local endpoint probe while disconnected
+	std::atomic_int64_t rttTrackAudio; // us, last ping round trip, -1 for unknown
 	auto TrackAudioMessageHandler(const ix::WebSocketMessagePtr& msg) -> void;
+	auto TrackAudioFrameHandler(const std::string& frame, const std::chrono::steady_clock::time_point& received = std::chrono::steady_clock::now()) -> void;
+	auto TrackAudioProbeVersion(const std::string address) -> void;
+	auto TrackAudioProbeLiveness(const std::string address) -> bool;
+	auto TrackAudioRequestStationStates(void) -> void;
+	StationSync stationSync; // TrackAudioMode 2, EuroScope channel changes -> TrackAudio
+	auto TrackAudioSyncStations(void) -> void; // EuroScope thread, on timer
+	StationUpdateQueue stationUpdates; // kStationStateUpdate held per station, see STATION_UPDATE_WINDOW_MS
+	auto PostStationUpdates(const station_push& push) -> void; // any thread
+	auto ApplyStationState(const station_update& update) -> void; // EuroScope thread
+	auto ReconcileChannels(const std::vector<int>& activeFrequencies) -> void; // EuroScope thread
 
 	// AFV standalone client controls
 	HWND hiddenWindowRDF = NULL;
 	HWND hiddenWindowAFV = NULL;
+	std::atomic_bool pendingRefresh = false; // WM_RDF_REFRESH posted and not yet handled
+	auto RequestScreenRefresh(void) -> void; // any thread, coalesced
 	WNDCLASS windowClassRDF = {
 	   NULL,
 	   HiddenWindowRDF,
@@ -183,19 +278,50 @@ private:
 	   "AfvBridgeHiddenWindowClass"
 	};
 
+	// metrics, see .RDF STATS
+	plugin_metrics metrics;
+	AsyncLogAppender<plog::TxtFormatterUtcTime>* logAppender = nullptr; // static in constructor, outlives plugin
+	auto ReportMetrics(const bool& display) -> void;
+
+	// capture & replay of audio client traffic
+	std::filesystem::path pathPlugin; // directory of DLL
+	CaptureWriter captureWriter;
+	ReplayClock clockTransmission; // keep-alive, expiry, history and tag ages
+	std::jthread threadReplay; // paces records, EuroScope thread delivers them
+	std::mutex mtxReplay;
+	std::condition_variable_any cvReplay; // room in queueReplay
+	std::deque<capture_record> queueReplay; // due records, time relative to first record
+	bool endReplay = false; // capture read to its end, under mtxReplay
+	bool activeReplay = false; // EuroScope thread only, as the rest below
+	std::chrono::steady_clock::time_point baseReplay; // transmission clock at first record
+	std::chrono::steady_clock::time_point startReplay;
+	size_t countReplay = 0; // records delivered
+	std::string nameReplay;
+	auto StartReplay(const std::filesystem::path& path, const double& speed) -> void;
+	auto StopReplay(const bool& display) -> void;
+	auto ReplayCapture(std::stop_token stop, CaptureReader reader, const double speed) -> void;
+
 	// settings related functions
 	auto GetRGB(COLORREF& color, const std::string& settingValue) -> void;
 	auto LoadTrackAudioSettings(void) -> void;
-	auto LoadDrawingSettings(const int& screenID = -1) -> void;
-	auto ProcessDrawingCommand(const std::string& command, const int& screenID = -1) -> bool;
+	auto LoadDrawingSettings(const screen_handle& screen = {}) -> void; // default handle for plugin settings
+	auto ProcessDrawingCommand(const std::string& command, const screen_handle& screen = {}) -> bool;
 
 	// functional things 
-	auto GenerateDrawPosition(std::string callsign) -> draw_position;
-	auto TrackAudioTransmissionHandler(const nlohmann::json& data, const bool& rxEnd) -> void;
+	auto SamplePosition(const inline_callsign& callsign) -> std::optional<position_sample>; // nullopt if neither aircraft nor controller, or filtered
+	auto GetTrackFilter(void) -> track_filter;
+	auto TrackAudioTransmissionHandler(const nlohmann::json& data, const bool& rxEnd, const rx_trace& trace) -> void;
+	auto PublishTransmission(const inline_callsign& callsign, draw_position& drawPosition) -> void; // needs unique lock on mtxTransmission
+	auto TouchTransmission(const size_t& row) -> void; // needs unique lock on mtxTransmission
+	auto ExpireTransmissions(void) -> void;
+	auto ClearTransmissions(void) -> void;
+	auto EndTransmission(const size_t& row) -> void; // needs unique lock on mtxTransmission, swap-removes row
+	auto FindTransmission(const inline_callsign& callsign) const -> std::optional<size_t>; // needs lock on mtxTransmission
+	auto ResetTransmissions(void) -> void; // needs unique lock on mtxTransmission
 	auto TrackAudioStationStatesHandler(const nlohmann::json& data) -> void;
 	auto TrackAudioStationStateUpdateHandler(const nlohmann::json& data) -> void;
-	auto SelectGroundToAirChannel(const std::optional<std::string>& callsign, const std::optional<int>& frequency) -> EuroScopePlugIn::CGrountToAirChannel;
-	auto UpdateChannel(const std::optional<std::string>& callsign, const std::optional<chnl_state>& channelState) -> void;
+	auto SelectGroundToAirChannel(const std::optional<inline_callsign>& callsign, const std::optional<int>& frequency) -> EuroScopePlugIn::CGrountToAirChannel;
+	auto UpdateChannel(const std::optional<inline_callsign>& callsign, const std::optional<chnl_state>& channelState) -> void;
 	auto ToggleChannel(EuroScopePlugIn::CGrountToAirChannel Channel, const std::optional<bool>& rx, const std::optional<bool>& tx) -> void;
 
 	// messages
@@ -214,10 +340,16 @@ private:
 public:
 	CRDFPlugin();
 	~CRDFPlugin();
-	auto GetDrawStations(void) -> callsign_position;
-	auto HiddenWndProcessRDFMessage(const std::string& message) -> void;
-	auto HiddenWndProcessAFVMessage(const std::string& message) -> void;
+	auto GetDrawGeometry(const int& screenID) -> std::shared_ptr<const draw_geometry>;
+	auto MarkDrawn(const draw_geometry& geometry) -> void;
+	auto HiddenWndProcessRDFMessage(const std::string_view& message, const bool& replayed = false) -> void;
+	auto HiddenWndRefreshScreens(void) -> void;
+	auto HiddenWndApplyStationStates(void) -> void;
+	auto HiddenWndReconnectTrackAudio(void) -> void;
+	auto HiddenWndProcessAFVMessage(const std::string_view& message, const bool& replayed = false) -> void;
+	auto HiddenWndReplayRecords(void) -> void;
 	virtual auto OnRadarScreenCreated(const char* sDisplayName, bool NeedRadarContent, bool GeoReferenced, bool CanBeSaved, bool CanBeCreated) -> EuroScopePlugIn::CRadarScreen*;
 	virtual auto OnCompileCommand(const char* sCommandLine) -> bool;
+	virtual auto OnTimer(int Counter) -> void;
 	virtual auto OnGetTagItem(EuroScopePlugIn::CFlightPlan FlightPlan, EuroScopePlugIn::CRadarTarget RadarTarget, int ItemCode, int TagData, char sItemString[16], int* pColorCode, COLORREF* pRGB, double* pFontSize) -> void;
 };
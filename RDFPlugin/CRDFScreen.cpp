@@ -3,9 +3,21 @@
 #include "stdafx.h"
 #include "CRDFScreen.h"
 
-CRDFScreen::CRDFScreen(const int& ID)
+// span names per refresh phase, index as refreshDuration
+static_assert(DRAW_LOD_MAX_VERTICES <= GEOMETRY_VERTICES && GEOMETRY_VERTICES % DRAW_LOD_VERTICES[DRAW_LOD_POLYGON] == 0 &&
+	GEOMETRY_VERTICES % DRAW_LOD_VERTICES[DRAW_LOD_POLYGON_COARSE] == 0, "LOD outlines must be subsets of the shared outline");
+
+constexpr std::array<const char*, EuroScopePlugIn::REFRESH_PHASE_AFTER_LISTS + 1> REFRESH_PHASE_NAMES = {
+	"OnRefresh BACK_BITMAP", "OnRefresh BEFORE_TAGS", "OnRefresh AFTER_TAGS", "OnRefresh AFTER_LISTS"
+};
+
+inline static auto ToLayer(const POINT& p) -> layer_point {
+	return { (int)p.x, (int)p.y };
+}
+
+CRDFScreen::CRDFScreen(const screen_handle& handle)
 {
-	m_ID = ID;
+	m_Handle = handle;
 	m_Opened = true;
 }
 
@@ -16,7 +28,7 @@ CRDFScreen::~CRDFScreen()
 auto CRDFScreen::OnAsrContentLoaded(bool Loaded) -> void
 {
 	if (Loaded) { // ASR load finished
-		GetRDFPlugin()->LoadDrawingSettings(m_ID);
+		GetRDFPlugin()->LoadDrawingSettings(m_Handle);
 	}
 }
 
@@ -29,82 +41,156 @@ auto CRDFScreen::OnAsrContentToBeSaved(void) -> void
 
 auto CRDFScreen::OnAsrContentToBeClosed(void) -> void
 {
-	m_Opened = false; // should not delete this to avoid crash
+	m_Opened = false;
+	GetRDFPlugin()->CloseScreen(m_Handle); // nothing refers to this screen afterwards
+	delete this; // last action, as EuroScope requires
 }
 
 auto CRDFScreen::OnRefresh(HDC hDC, int Phase) -> void
 {
-	if (Phase == EuroScopePlugIn::REFRESH_PHASE_BACK_BITMAP) {
-		GetRDFPlugin()->vidScreen = m_ID;
-		return;
-	}
+	size_t phaseIndex = min(max(Phase, 0), (int)refreshDuration.size() - 1);
+	ScopedMetricTimer timer(refreshDuration[phaseIndex]);
+	RDF_TRACE_SCOPE(REFRESH_PHASE_NAMES[phaseIndex]);
 	if (Phase != EuroScopePlugIn::REFRESH_PHASE_AFTER_TAGS) return;
 
-	callsign_position drawPosition = GetRDFPlugin()->GetDrawStations();
-	if (drawPosition.empty()) {
+	auto geometry = GetRDFPlugin()->GetDrawGeometry(m_Handle.id);
+	if (geometry->rows.Empty()) {
 		return;
 	}
 
-	draw_settings params = GetRDFPlugin()->GetDrawingParam();
-	HGDIOBJ oldBrush = SelectObject(hDC, GetStockObject(HOLLOW_BRUSH));
-	COLORREF penColor = drawPosition.size() > 1 ? params.rdfConcurRGB : params.rdfRGB;
-	HPEN hPen = CreatePen(PS_SOLID, 1, penColor);
-	HGDIOBJ oldPen = SelectObject(hDC, hPen);
+	auto settings = GetRDFPlugin()->GetDrawingParam(m_Handle.id);
+	const draw_settings& params = *settings;
+	RECT radarArea = GetRadarArea();
+	EuroScopePlugIn::CPosition posLD, posRU;
+	GetDisplayArea(&posLD, &posRU);
+	draw_lod lod = frameBudget.Level();
+
+	// layer is only rendered again when anything it depends on changed
+	LayerKey key;
+	key.Add(geometry->build);
+	key.Add(params.rdfRGB);
+	key.Add(params.rdfConcurRGB);
+	key.Add(params.circleThreshold);
+	key.Add(params.clusterOverlap);
+	key.Add(radarArea);
+	key.Add(posLD.m_Latitude);
+	key.Add(posLD.m_Longitude);
+	key.Add(posRU.m_Latitude);
+	key.Add(posRU.m_Longitude);
+	key.Add(lod);
+	if (!layerCache.Hit(key.Value())) {
+		auto drawStart = std::chrono::steady_clock::now();
+		RenderLayer(layer, *geometry, params, radarArea, posLD, posRU, lod);
+		frameBudget.Record(std::chrono::steady_clock::now() - drawStart, geometry->rows.Size(), GetRDFPlugin()->frameBudgetUs);
+	}
+	layer.Composite(hDC);
+	GetRDFPlugin()->MarkDrawn(*geometry);
+}
 
-	for (auto& callsignPos : drawPosition) {
-		POINT pPos = ConvertCoordFromPositionToPixel(callsignPos.second.position);
-		if (PlaneIsVisible(pPos, GetRadarArea())) {
-			double drawR = callsignPos.second.radius;
+auto CRDFScreen::RenderLayer(LayerRasterizer& raster, const draw_geometry& geometry, const draw_settings& params, const RECT& radarArea, const EuroScopePlugIn::CPosition& posLD, const EuroScopePlugIn::CPosition& posRU, const draw_lod& lod) -> void
+{
+	// only projection and culling here, geographic outlines come with the shared geometry
+	const TransmissionTable& drawPosition = geometry.rows;
+	// overlapping transmissions on the same frequency use concurrent color
+	// layer uses target coordinates, so it spans from origin to the far corner of area
+	raster.Begin(radarArea.right, radarArea.bottom, params.rdfRGB, params.rdfConcurRGB);
+
+	// pixels per nautical mile, same for all rows
+	double pixelPerNM = 1.0;
+	if (params.circleThreshold >= 0) {
+		POINT pLD = ConvertCoordFromPositionToPixel(posLD);
+		POINT pRU = ConvertCoordFromPositionToPixel(posRU);
+		double dst = sqrt(pow(pRU.x - pLD.x, 2) + pow(pRU.y - pLD.y, 2));
+		pixelPerNM = dst / posLD.DistanceTo(posRU);
+	}
+
+	circles.clear();
+	for (size_t i = 0; i < drawPosition.Size(); i++) {
+		POINT pPos = ConvertCoordFromPositionToPixel(geometry.Position(i));
+		if (lod < DRAW_LOD_LINE && PlaneIsVisible(pPos, radarArea)) {
+			double drawR = drawPosition.radius[i];
 			// deal with drawing radius when threshold enabled
 			if (params.circleThreshold >= 0) {
-				EuroScopePlugIn::CPosition posLD, posRU;
-				GetDisplayArea(&posLD, &posRU);
-				POINT pLD = ConvertCoordFromPositionToPixel(posLD);
-				POINT pRU = ConvertCoordFromPositionToPixel(posRU);
-				double dst = sqrt(pow(pRU.x - pLD.x, 2) + pow(pRU.y - pLD.y, 2));
-				drawR = drawR * dst / posLD.DistanceTo(posRU);
+				drawR = drawR * pixelPerNM;
 			}
 			if (drawR >= (double)params.circleThreshold) {
-				// draw circle
-				if (params.circleThreshold >= 0) {
-					// using position as boundary xy
-					EuroScopePlugIn::CPosition pl = callsignPos.second.position;
-					AddOffset(pl, 270, callsignPos.second.radius);
-					EuroScopePlugIn::CPosition pt = callsignPos.second.position;
-					AddOffset(pt, 0, callsignPos.second.radius);
-					EuroScopePlugIn::CPosition pr = callsignPos.second.position;
-					AddOffset(pr, 90, callsignPos.second.radius);
-					EuroScopePlugIn::CPosition pb = callsignPos.second.position;
-					AddOffset(pb, 180, callsignPos.second.radius);
-					Ellipse(hDC,
-						ConvertCoordFromPositionToPixel(pl).x,
-						ConvertCoordFromPositionToPixel(pt).y,
-						ConvertCoordFromPositionToPixel(pr).x,
-						ConvertCoordFromPositionToPixel(pb).y
-					);
-				}
-				else {
-					// using pixel as boundary xy
-					Ellipse(hDC, pPos.x - (int)round(drawR), pPos.y - (int)round(drawR), pPos.x + (int)round(drawR), pPos.y + (int)round(drawR));
-				}
+				circles.push_back({ (double)pPos.x, (double)pPos.y, drawR, i });
 				continue;
 			}
 		}
 		// draw line
-		POINT oldPoint;
-		MoveToEx(hDC, (GetRadarArea().right - GetRadarArea().left) / 2, (GetRadarArea().bottom - GetRadarArea().top) / 2, &oldPoint);
-		LineTo(hDC, pPos.x, pPos.y);
-		MoveToEx(hDC, oldPoint.x, oldPoint.y, NULL);
+		raster.SelectPen(drawPosition.flags[i] & TX_FLAG_OVERLAP);
+		raster.Line({ (int)(radarArea.right - radarArea.left) / 2, (int)(radarArea.bottom - radarArea.top) / 2 }, ToLayer(pPos));
 	}
 
-	SelectObject(hDC, oldBrush);
-	SelectObject(hDC, oldPen);
-	DeleteObject(hPen);
+	if (params.clusterOverlap >= 0 && circles.size() > 1) {
+		// merged circles are drawn in pixel space with a count label
+		for (const auto& cluster : clusterer.Build(circles, drawPosition.flags, params.clusterOverlap)) {
+			raster.SelectPen(cluster.flags & TX_FLAG_OVERLAP);
+			layer_point pPos = { (int)round(cluster.x), (int)round(cluster.y) };
+			if (cluster.count == 1) {
+				DrawCircle(raster, geometry, cluster.first, pPos, cluster.r, lod, params.circleThreshold);
+				continue;
+			}
+			if (lod == DRAW_LOD_MARKER) {
+				DrawMarker(raster, pPos);
+			}
+			else {
+				int r = (int)round(cluster.r);
+				raster.Ellipse(pPos.x - r, pPos.y - r, pPos.x + r, pPos.y + r);
+			}
+			raster.Text({ pPos.x, pPos.y + LAYER_FONT_HEIGHT / 3 }, std::to_string(cluster.count));
+		}
+	}
+	else {
+		for (const auto& circle : circles) {
+			raster.SelectPen(drawPosition.flags[circle.row] & TX_FLAG_OVERLAP);
+			layer_point pPos = { (int)circle.x, (int)circle.y };
+			DrawCircle(raster, geometry, circle.row, pPos, circle.r, lod, params.circleThreshold);
+		}
+	}
+	raster.End();
+}
+
+auto CRDFScreen::DrawCircle(LayerRasterizer& raster, const draw_geometry& geometry, const size_t& row, const layer_point& pPos, const double& drawR, const draw_lod& lod, const int& circleThreshold) -> void
+{
+	if (lod == DRAW_LOD_MARKER) {
+		DrawMarker(raster, pPos);
+		return;
+	}
+	if (circleThreshold >= 0 && lod < DRAW_LOD_ELLIPSE) {
+		// geodesic polygon, every n-th point of the shared outline
+		std::array<layer_point, DRAW_LOD_MAX_VERTICES> vertices;
+		int count = DRAW_LOD_VERTICES[lod];
+		for (int v = 0; v < count; v++) {
+			vertices[v] = ToLayer(ConvertCoordFromPositionToPixel(geometry.Outline(row, v * GEOMETRY_VERTICES / count)));
+		}
+		raster.Polygon(vertices.data(), count);
+	}
+	else if (circleThreshold >= 0) {
+		// using outline points as boundary xy
+		raster.Ellipse(
+			ConvertCoordFromPositionToPixel(geometry.OutlineAt(row, 270)).x,
+			ConvertCoordFromPositionToPixel(geometry.OutlineAt(row, 0)).y,
+			ConvertCoordFromPositionToPixel(geometry.OutlineAt(row, 90)).x,
+			ConvertCoordFromPositionToPixel(geometry.OutlineAt(row, 180)).y
+		);
+	}
+	else {
+		// using pixel as boundary xy
+		raster.Ellipse(pPos.x - (int)round(drawR), pPos.y - (int)round(drawR), pPos.x + (int)round(drawR), pPos.y + (int)round(drawR));
+	}
+}
+
+auto CRDFScreen::DrawMarker(LayerRasterizer& raster, const layer_point& pPos) -> void
+{
+	raster.Line({ pPos.x - DRAW_MARKER_PX, pPos.y }, { pPos.x + DRAW_MARKER_PX + 1, pPos.y });
+	raster.Line({ pPos.x, pPos.y - DRAW_MARKER_PX }, { pPos.x, pPos.y + DRAW_MARKER_PX + 1 });
 }
 
 auto CRDFScreen::OnCompileCommand(const char* sCommandLine) -> bool
 {
-	return GetRDFPlugin()->ProcessDrawingCommand(sCommandLine, m_ID);
+	return GetRDFPlugin()->ProcessDrawingCommand(sCommandLine, m_Handle);
 }
 
 auto CRDFScreen::GetRDFPlugin(void) -> CRDFPlugin*
@@ -2,6 +2,17 @@
 
 #include "stdafx.h"
 #include "CRDFPlugin.h"
+#include "RDFMetrics.h"
+#include "RDFTrace.h"
+#include "RDFTransmissionTable.h"
+#include "RDFGeometry.h"
+#include "RDFFrameBudget.h"
+#include "RDFCluster.h"
+#include "RDFLayer.h"
+#include "RDFLayerGdi.h"
+#include "RDFScreenRegistry.h"
+
+typedef struct _draw_settings draw_settings; // see CRDFPlugin.h, which includes this header
 
 typedef struct _asr_to_save {
 	std::string descr;
@@ -13,17 +24,28 @@ class CRDFScreen : public EuroScopePlugIn::CRadarScreen
 private:
 	friend class CRDFPlugin;
 
-	int m_ID;
+	screen_handle m_Handle; // slot in CRDFPlugin::screens
 	std::map<std::string, asr_to_save> newAsrData; // sVariableName -> asr_to_save
 
 	inline auto GetRDFPlugin(void) -> CRDFPlugin*;
 	auto PlaneIsVisible(const POINT& p, const RECT& radarArea) -> bool;
 
+	// drawing, buffers reused between frames
+	std::vector<screen_circle> circles;
+	CircleClusterer clusterer;
+	GdiLayerRasterizer layer;
+	LayerCache layerCache;
+	auto RenderLayer(LayerRasterizer& raster, const draw_geometry& geometry, const draw_settings& params, const RECT& radarArea, const EuroScopePlugIn::CPosition& posLD, const EuroScopePlugIn::CPosition& posRU, const draw_lod& lod) -> void;
+	auto DrawCircle(LayerRasterizer& raster, const draw_geometry& geometry, const size_t& row, const layer_point& pPos, const double& drawR, const draw_lod& lod, const int& circleThreshold) -> void;
+	auto DrawMarker(LayerRasterizer& raster, const layer_point& pPos) -> void;
+
 public:
-	CRDFScreen(const int& ID);
+	CRDFScreen(const screen_handle& handle);
 	~CRDFScreen(void);
 
 	bool m_Opened;
+	std::array<MetricHistogram, EuroScopePlugIn::REFRESH_PHASE_AFTER_LISTS + 1> refreshDuration; // per refresh phase
+	FrameBudget frameBudget; // level of detail of RDF drawing
 
 	virtual auto OnAsrContentLoaded(bool Loaded) -> void;
 	virtual auto OnAsrContentToBeSaved(void) -> void;
@@ -7,6 +7,7 @@ CRDFPlugin* rdfPlugin;
 
 LRESULT CALLBACK HiddenWindowRDF(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+	RDF_TRACE_SCOPE("HiddenWindowRDF");
 	switch (msg) {
 	case WM_CREATE: {
 		rdfPlugin = reinterpret_cast<CRDFPlugin*>(reinterpret_cast<CREATESTRUCT*>(lParam)->lpCreateParams);
@@ -16,10 +17,42 @@ LRESULT CALLBACK HiddenWindowRDF(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPar
 		COPYDATASTRUCT* data = reinterpret_cast<COPYDATASTRUCT*>(lParam);
 
 		if (data != nullptr && data->dwData == 666 && data->lpData != nullptr && rdfPlugin != nullptr) {
-			rdfPlugin->HiddenWndProcessRDFMessage(reinterpret_cast<const char*>(data->lpData));
+			// bounded by cbData, payload is not required to be NUL-terminated
+			const char* payload = reinterpret_cast<const char*>(data->lpData);
+			rdfPlugin->HiddenWndProcessRDFMessage(std::string_view(payload, strnlen(payload, data->cbData)));
 		}
 		return TRUE;
 	}
+	case WM_RDF_REFRESH: {
+		if (rdfPlugin != nullptr) {
+			rdfPlugin->HiddenWndRefreshScreens();
+		}
+		return TRUE;
+	}
+	case WM_RDF_STATIONS: {
+		if (rdfPlugin != nullptr) {
+			rdfPlugin->HiddenWndApplyStationStates();
+		}
+		return TRUE;
+	}
+	case WM_RDF_RECONNECT: {
+		if (rdfPlugin != nullptr) {
+			rdfPlugin->HiddenWndReconnectTrackAudio();
+		}
+		return TRUE;
+	}
+	case WM_RDF_REPLAY: {
+		if (rdfPlugin != nullptr) {
+			rdfPlugin->HiddenWndReplayRecords();
+		}
+		return TRUE;
+	}
+	case WM_TIMER: {
+		if (wParam == TIMER_RDF_STATIONS && rdfPlugin != nullptr) {
+			rdfPlugin->HiddenWndApplyStationStates();
+		}
+		return 0;
+	}
 	}
 
 	return DefWindowProc(hwnd, msg, wParam, lParam);
@@ -27,6 +60,7 @@ LRESULT CALLBACK HiddenWindowRDF(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPar
 
 LRESULT CALLBACK HiddenWindowAFV(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+	RDF_TRACE_SCOPE("HiddenWindowAFV");
 	switch (msg) {
 	case WM_CREATE: {
 		rdfPlugin = reinterpret_cast<CRDFPlugin*>(reinterpret_cast<CREATESTRUCT*>(lParam)->lpCreateParams);
@@ -36,7 +70,9 @@ LRESULT CALLBACK HiddenWindowAFV(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPar
 		COPYDATASTRUCT* data = reinterpret_cast<COPYDATASTRUCT*>(lParam);
 
 		if (data != nullptr && data->dwData == 666 && data->lpData != nullptr && rdfPlugin != nullptr) {
-			rdfPlugin->HiddenWndProcessAFVMessage(reinterpret_cast<const char*>(data->lpData));
+			// bounded by cbData, payload is not required to be NUL-terminated
+			const char* payload = reinterpret_cast<const char*>(data->lpData);
+			rdfPlugin->HiddenWndProcessAFVMessage(std::string_view(payload, strnlen(payload, data->cbData)));
 		}
 		return TRUE;
 	}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Inline callsign value, trivially copyable and never allocates
+// Longer callsigns are truncated, hash and length still cover the full text so
+// truncated callsigns only compare equal if the whole input was equal.
+constexpr size_t CALLSIGN_CAPACITY = 16; // bytes incl. NUL, 15 characters
+
+typedef struct _inline_callsign {
+	std::array<char, CALLSIGN_CAPACITY> chars = {}; // NUL padded
+	uint32_t hash = 0; // FNV-1a of full input
+	uint32_t length = 0; // of full input
+
+	_inline_callsign(void) = default;
+	_inline_callsign(const std::string_view& callsign) {
+		uint32_t h = 2166136261U;
+		for (size_t i = 0; i < callsign.size(); i++) {
+			h = (h ^ (uint8_t)callsign[i]) * 16777619U;
+			if (i < CALLSIGN_CAPACITY - 1) chars[i] = callsign[i];
+		}
+		hash = h;
+		length = (uint32_t)callsign.size();
+	}
+	_inline_callsign(const char* callsign) :
+		_inline_callsign(std::string_view(callsign != nullptr ? callsign : ""))
+	{
+	};
+
+	auto Empty(void) const -> bool {
+		return !chars[0];
+	}
+	auto CStr(void) const -> const char* {
+		return chars.data();
+	}
+	auto View(void) const -> std::string_view {
+		return std::string_view(chars.data(), std::find(chars.begin(), chars.end(), '\0') - chars.begin());
+	}
+	auto String(void) const -> std::string {
+		return std::string(View());
+	}
+	auto operator==(const _inline_callsign& other) const -> bool {
+		return hash == other.hash && length == other.length && chars == other.chars;
+	}
+	auto operator<(const _inline_callsign& other) const -> bool {
+		// same order as std::string for NUL padded text
+		int cmp = std::memcmp(chars.data(), other.chars.data(), CALLSIGN_CAPACITY);
+		return cmp < 0 || (cmp == 0 && (length < other.length || (length == other.length && hash < other.hash)));
+	}
+} inline_callsign;
+
+template<>
+struct std::hash<inline_callsign> {
+	auto operator()(const inline_callsign& callsign) const noexcept -> size_t {
+		return callsign.hash;
+	}
+};
+
+inline auto operator<<(std::ostream& os, const inline_callsign& callsign) -> std::ostream& {
+	return os << callsign.View();
+}
+
+// Maps callsigns to dense IDs for flat per-callsign arrays, not thread safe
+// IDs are reference counted by their holders and reused once released, so the
+// table is bounded by the callsigns currently held, not by all callsigns ever seen.
+class CallsignInterner
+{
+private:
+	std::unordered_map<inline_callsign, uint32_t> ids;
+	std::vector<inline_callsign> names; // ID -> callsign
+	std::vector<uint32_t> refs; // ID -> holders, 0 if free
+	std::vector<uint32_t> freeIds; // reused last in first out
+
+public:
+	// interns and adds a reference
+	auto Acquire(const inline_callsign& callsign) -> uint32_t {
+		auto [it, inserted] = ids.try_emplace(callsign, 0);
+		if (inserted) {
+			if (freeIds.size()) {
+				it->second = freeIds.back();
+				freeIds.pop_back();
+				names[it->second] = callsign;
+			}
+			else {
+				it->second = (uint32_t)names.size();
+				names.push_back(callsign);
+				refs.push_back(0);
+			}
+		}
+		refs[it->second]++;
+		return it->second;
+	}
+	// drops a reference, the ID is freed with the last one
+	auto Release(const uint32_t& id) -> void {
+		if (id >= refs.size() || !refs[id] || --refs[id]) return;
+		ids.erase(names[id]);
+		names[id] = {};
+		freeIds.push_back(id);
+	}
+	auto Find(const inline_callsign& callsign) const -> std::optional<uint32_t> {
+		auto it = ids.find(callsign);
+		if (it == ids.end()) return std::nullopt;
+		return it->second;
+	}
+	auto Name(const uint32_t& id) const -> const inline_callsign& {
+		return names.at(id);
+	}
+	// IDs in use
+	auto Size(void) const -> size_t {
+		return ids.size();
+	}
+	// bound of IDs handed out, for flat arrays
+	auto Capacity(void) const -> size_t {
+		return names.size();
+	}
+	auto Clear(void) -> void {
+		ids.clear();
+		names.clear();
+		refs.clear();
+		freeIds.clear();
+	}
+};
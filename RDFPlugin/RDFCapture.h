@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Capture of audio client traffic for replay
+// File layout: CAPTURE_MAGIC, then records of
+// [uint64 time in us since capture start][uint8 source][uint32 payload size][payload]
+constexpr auto CAPTURE_MAGIC = "RDFCAP01";
+constexpr size_t CAPTURE_MAGIC_SIZE = 8;
+constexpr size_t CAPTURE_FLUSH_BYTES = 64 * 1024;
+constexpr size_t CAPTURE_MAX_PAYLOAD = 1024 * 1024; // bytes, far above any audio client message, larger sizes are corrupt
+constexpr auto CAPTURE_FLUSH_INTERVAL = std::chrono::milliseconds(200);
+
+enum capture_source : uint8_t {
+	CAPTURE_SOURCE_WS = 0, // TrackAudio WebSocket frame
+	CAPTURE_SOURCE_RDF = 1, // WM_COPYDATA to HiddenWindowRDF
+	CAPTURE_SOURCE_AFV = 2, // WM_COPYDATA to HiddenWindowAFV
+};
+
+typedef struct _capture_record {
+	uint64_t time = 0; // us
+	capture_source source = CAPTURE_SOURCE_WS;
+	std::string payload;
+} capture_record;
+
+class CaptureWriter
+{
+private:
+	std::atomic_bool active = false; // set under mtxBuffer, Record checks it again there
+	std::atomic_bool suppressed = false; // while replaying, replayed messages would be recorded again
+	std::chrono::steady_clock::time_point timeStart;
+	std::mutex mtxBuffer;
+	std::condition_variable cvBuffer;
+	std::vector<char> buffer; // filled by producers, swapped out by writer
+	std::ofstream file;
+	std::jthread threadWriter;
+
+	auto WriterLoop(std::stop_token stop) -> void {
+		std::vector<char> pending;
+		while (true) {
+			{
+				std::unique_lock lock(mtxBuffer);
+				cvBuffer.wait_for(lock, CAPTURE_FLUSH_INTERVAL, [&] { return stop.stop_requested() || buffer.size() >= CAPTURE_FLUSH_BYTES; });
+				pending.swap(buffer);
+			}
+			if (pending.size()) {
+				file.write(pending.data(), pending.size());
+				pending.clear();
+			}
+			if (stop.stop_requested()) break;
+		}
+		file.flush();
+	}
+
+public:
+	~CaptureWriter(void) {
+		Stop();
+	}
+
+	auto IsActive(void) const -> bool {
+		return active;
+	}
+
+	auto Suppress(const bool& suppress) -> void {
+		suppressed = suppress;
+	}
+
+	auto Start(const std::filesystem::path& path) -> bool {
+		Stop();
+		file.open(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return false;
+		file.write(CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE);
+		{
+			std::lock_guard lock(mtxBuffer);
+			buffer.clear();
+			timeStart = std::chrono::steady_clock::now();
+			active = true;
+		}
+		threadWriter = std::jthread(std::bind_front(&CaptureWriter::WriterLoop, this));
+		return true;
+	}
+
+	auto Stop(void) -> void {
+		if (!threadWriter.joinable()) return;
+		{
+			std::lock_guard lock(mtxBuffer);
+			active = false; // no Record appends after this
+		}
+		threadWriter.request_stop();
+		cvBuffer.notify_one();
+		threadWriter.join();
+		file.close();
+		std::lock_guard lock(mtxBuffer);
+		buffer.clear();
+	}
+
+	auto Record(const capture_source& source, const std::string_view& payload) -> void {
+		// called from WS and window threads, only copies into the shared buffer
+		if (!active || suppressed || payload.size() > CAPTURE_MAX_PAYLOAD) return;
+		uint32_t size = (uint32_t)payload.size();
+		std::unique_lock lock(mtxBuffer);
+		if (!active) return; // raced with Stop, the file is closed
+		uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+		size_t offset = buffer.size();
+		buffer.resize(offset + sizeof(time) + sizeof(source) + sizeof(size) + size);
+		char* p = buffer.data() + offset;
+		std::memcpy(p, &time, sizeof(time));
+		p += sizeof(time);
+		std::memcpy(p, &source, sizeof(source));
+		p += sizeof(source);
+		std::memcpy(p, &size, sizeof(size));
+		p += sizeof(size);
+		std::memcpy(p, payload.data(), size);
+		if (buffer.size() >= CAPTURE_FLUSH_BYTES) {
+			lock.unlock();
+			cvBuffer.notify_one();
+		}
+	}
+};
+
+class CaptureReader
+{
+private:
+	std::ifstream file;
+	uint64_t fileSize = 0;
+
+public:
+	auto Open(const std::filesystem::path& path) -> bool {
+		std::error_code ec;
+		fileSize = std::filesystem::file_size(path, ec);
+		if (ec) return false;
+		file.open(path, std::ios::binary);
+		char magic[CAPTURE_MAGIC_SIZE] = { 0 };
+		file.read(magic, CAPTURE_MAGIC_SIZE);
+		return file.good() && std::string_view(magic, CAPTURE_MAGIC_SIZE) == CAPTURE_MAGIC;
+	}
+
+	auto Next(capture_record& record) -> bool {
+		uint32_t size = 0;
+		file.read(reinterpret_cast<char*>(&record.time), sizeof(record.time));
+		file.read(reinterpret_cast<char*>(&record.source), sizeof(record.source));
+		file.read(reinterpret_cast<char*>(&size), sizeof(size));
+		if (!file.good() || record.source > CAPTURE_SOURCE_AFV) return false;
+		// a truncated or corrupt file must not size the allocation
+		if (size > CAPTURE_MAX_PAYLOAD || size > fileSize - (uint64_t)file.tellg()) return false;
+		record.payload.resize(size);
+		file.read(record.payload.data(), size);
+		return file.good();
+	}
+
+	// time from first to last record in us, reads headers only and rewinds
+	auto Span(void) -> uint64_t {
+		auto start = file.tellg();
+		std::optional<uint64_t> first;
+		uint64_t last = 0;
+		while (true) {
+			uint64_t time = 0;
+			capture_source source = CAPTURE_SOURCE_WS;
+			uint32_t size = 0;
+			file.read(reinterpret_cast<char*>(&time), sizeof(time));
+			file.read(reinterpret_cast<char*>(&source), sizeof(source));
+			file.read(reinterpret_cast<char*>(&size), sizeof(size));
+			if (!file.good()) break;
+			if (!first) {
+				first = time;
+			}
+			last = time;
+			file.seekg(size, std::ios::cur);
+		}
+		file.clear();
+		file.seekg(start);
+		return first ? last - *first : 0;
+	}
+};
+
+// Clock of the transmission paths: keep-alive, expiry, history and tag ages
+// Live it is steady_clock. During a replay it holds the capture time of the
+// record being delivered, so the recorded spacing holds at any replay speed and
+// a replay is repeatable. Latency traces stay on steady_clock.
+class ReplayClock
+{
+private:
+	std::atomic_bool replaying = false;
+	std::atomic<std::chrono::steady_clock::rep> virtualNow = 0;
+
+public:
+	auto Now(void) const -> std::chrono::steady_clock::time_point {
+		if (!replaying.load(std::memory_order_acquire)) return std::chrono::steady_clock::now();
+		return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(virtualNow.load(std::memory_order_relaxed)));
+	}
+
+	auto Replaying(void) const -> bool {
+		return replaying;
+	}
+
+	// capture time 0 maps to the returned base, chosen so the virtual clock never
+	// runs ahead of steady_clock and meets it at the end of a replay at speed >= 1
+	static auto Base(const std::chrono::steady_clock::time_point& wallStart, const uint64_t& spanUs, const double& speed) -> std::chrono::steady_clock::time_point {
+		double behind = speed > 0 ? (std::max)(1.0 - 1.0 / speed, 0.0) : 1.0; // speed <= 0: as fast as possible
+		return wallStart - std::chrono::microseconds((long long)(spanUs * behind));
+	}
+
+	// EuroScope thread, as Set and End
+	auto Begin(const std::chrono::steady_clock::time_point& start) -> void {
+		virtualNow.store(start.time_since_epoch().count(), std::memory_order_relaxed);
+		replaying.store(true, std::memory_order_release);
+	}
+
+	auto Set(const std::chrono::steady_clock::time_point& time) -> void {
+		virtualNow.store((std::max)(virtualNow.load(std::memory_order_relaxed), time.time_since_epoch().count()), std::memory_order_relaxed);
+	}
+
+	auto End(void) -> void {
+		replaying.store(false, std::memory_order_release);
+	}
+};
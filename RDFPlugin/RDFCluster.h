@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Screen-space clustering of RDF circles, one per screen, EuroScope thread only
+// Circles are merged greedily into the first cluster whose seed circle they overlap
+// by at least the style threshold. Seeds are kept in a grid hash with cell size of
+// the largest diameter, so only the 3x3 neighbouring cells can hold a match. Seeds
+// that did not merge can still crowd one cell (mixed radii, one large circle), so
+// only the newest CLUSTER_CELL_PROBES seeds of each cell are compared and a frame
+// costs O(n). A circle whose match is further down starts its own cluster.
+// Buffers are reused between frames.
+constexpr auto CLUSTER_OVERLAP_DEFAULT = 75; // percent, style default, negative disables
+constexpr int CLUSTER_CELL_PROBES = 16; // seeds compared per neighbouring cell and circle
+
+typedef struct _screen_circle {
+	double x;
+	double y;
+	double r; // px
+	size_t row; // in draw snapshot
+} screen_circle;
+
+typedef struct _circle_cluster {
+	double x; // bounding circle
+	double y;
+	double r;
+	size_t count;
+	size_t first; // row of seed
+	uint8_t flags; // OR of member row flags
+} circle_cluster;
+
+class CircleClusterer
+{
+private:
+	std::vector<screen_circle> seeds; // parallel to clusters
+	std::vector<circle_cluster> clusters;
+	std::vector<int32_t> heads; // grid hash bucket -> first seed, -1 if empty
+	std::vector<int32_t> next; // seed -> next seed in bucket
+	size_t mask = 0;
+	double cell = 1;
+
+	auto Bucket(const int64_t& cx, const int64_t& cy) const -> size_t {
+		return (size_t)((cx * 73856093) ^ (cy * 19349663)) & mask;
+	}
+	auto Cell(const double& v) const -> int64_t {
+		return (int64_t)std::floor(v / cell);
+	}
+
+	// overlap of two circles, 1 when concentric and 0 when touching
+	static auto Overlap(const screen_circle& a, const screen_circle& b) -> double {
+		double sum = a.r + b.r;
+		if (sum <= 0) return 1;
+		double dx = a.x - b.x, dy = a.y - b.y;
+		return 1.0 - std::sqrt(dx * dx + dy * dy) / sum;
+	}
+
+	static auto Enclose(circle_cluster& c, const screen_circle& s) -> void {
+		double dx = s.x - c.x, dy = s.y - c.y;
+		double d = std::sqrt(dx * dx + dy * dy);
+		if (d + s.r <= c.r) return;
+		if (d + c.r <= s.r) {
+			c.x = s.x;
+			c.y = s.y;
+			c.r = s.r;
+			return;
+		}
+		double r = (d + c.r + s.r) / 2;
+		c.x += (s.x - c.x) * (r - c.r) / d;
+		c.y += (s.y - c.y) * (r - c.r) / d;
+		c.r = r;
+	}
+
+public:
+	// flags[row] is the row flag column of the snapshot, threshold in percent
+	auto Build(const std::vector<screen_circle>& circles, const std::vector<uint8_t>& flags, const int& threshold) -> const std::vector<circle_cluster>& {
+		seeds.clear();
+		clusters.clear();
+		size_t buckets = 16;
+		while (buckets < circles.size() * 2) buckets <<= 1;
+		mask = buckets - 1;
+		heads.assign(buckets, -1);
+		next.clear();
+		double maxR = 0;
+		for (const auto& c : circles) {
+			maxR = (std::max)(maxR, c.r);
+		}
+		cell = (std::max)(maxR * 2, 1.0);
+		double minOverlap = threshold / 100.0;
+		for (const auto& c : circles) {
+			int64_t cx = Cell(c.x), cy = Cell(c.y);
+			int32_t found = -1;
+			for (int64_t dx = -1; dx <= 1 && found < 0; dx++) {
+				for (int64_t dy = -1; dy <= 1 && found < 0; dy++) {
+					int probes = 0;
+					for (int32_t s = heads[Bucket(cx + dx, cy + dy)]; s >= 0 && probes < CLUSTER_CELL_PROBES; s = next[s], probes++) {
+						if (Overlap(seeds[s], c) >= minOverlap) {
+							found = s;
+							break;
+						}
+					}
+				}
+			}
+			if (found >= 0) {
+				auto& cluster = clusters[found];
+				Enclose(cluster, c);
+				cluster.count++;
+				cluster.flags |= flags[c.row];
+				continue;
+			}
+			size_t bucket = Bucket(cx, cy);
+			next.push_back(heads[bucket]);
+			heads[bucket] = (int32_t)seeds.size();
+			seeds.push_back(c);
+			clusters.push_back({ c.x, c.y, c.r, 1, c.row, flags[c.row] });
+		}
+		return clusters;
+	}
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "stdafx.h"
+
+// Adaptive level of detail for the RDF overlay, one per screen, EuroScope thread only
+// Cost is tracked per drawn row and per level, so stepping back up is only done
+// when the finer level is predicted to fit well inside the budget.
+enum draw_lod : int {
+	DRAW_LOD_POLYGON = 0, // geodesic polygon
+	DRAW_LOD_POLYGON_COARSE,
+	DRAW_LOD_ELLIPSE, // ellipse through 4 geodesic points
+	DRAW_LOD_MARKER, // fixed size cross at centre
+	DRAW_LOD_LINE, // line from screen centre
+	DRAW_LOD_LEVELS
+};
+constexpr std::array<const char*, DRAW_LOD_LEVELS> DRAW_LOD_NAMES = { "polygon", "coarse polygon", "ellipse", "marker", "line" };
+constexpr std::array<int, DRAW_LOD_ELLIPSE> DRAW_LOD_VERTICES = { 36, 12 }; // per polygon level
+constexpr int DRAW_LOD_MAX_VERTICES = 36;
+constexpr int DRAW_MARKER_PX = 4; // half size of centre marker
+constexpr auto FRAME_BUDGET_DEFAULT_US = 2000; // SETTING_FRAME_BUDGET default
+constexpr double FRAME_BUDGET_UP_RATIO = 0.5; // finer level must be predicted below this share of budget
+constexpr int FRAME_BUDGET_HOLD_FRAMES = 10; // frames between two level changes
+constexpr double FRAME_BUDGET_SMOOTHING = 0.2; // weight of newest frame in cost average
+
+class FrameBudget
+{
+private:
+	std::array<double, DRAW_LOD_LEVELS> costPerRow = {}; // ns, moving average, 0 if never drawn
+	int level = DRAW_LOD_POLYGON;
+	int hold = 0; // frames left before next change
+	uint64_t stepsDown = 0;
+	uint64_t stepsUp = 0;
+
+public:
+	auto Level(void) const -> draw_lod {
+		return (draw_lod)level;
+	}
+
+	// records a frame drawn at Level(), budget 0 disables and restores full detail
+	auto Record(const std::chrono::steady_clock::duration& elapsed, const size_t& rows, const int& budgetUs) -> void {
+		if (budgetUs <= 0) {
+			level = DRAW_LOD_POLYGON;
+			hold = 0;
+			return;
+		}
+		if (!rows) return;
+		double perRow = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / rows;
+		double& cost = costPerRow[level];
+		cost = cost > 0 ? cost + FRAME_BUDGET_SMOOTHING * (perRow - cost) : perRow;
+		if (hold > 0) {
+			hold--;
+			return;
+		}
+		double budgetNs = budgetUs * 1000.0;
+		if (cost * rows > budgetNs && level < DRAW_LOD_LINE) {
+			level++;
+			hold = FRAME_BUDGET_HOLD_FRAMES;
+			stepsDown++;
+		}
+		else if (level > DRAW_LOD_POLYGON && costPerRow[level - 1] * rows < budgetNs * FRAME_BUDGET_UP_RATIO) {
+			level--;
+			hold = FRAME_BUDGET_HOLD_FRAMES;
+			stepsUp++;
+		}
+	}
+
+	auto Summary(void) const -> std::string {
+		return std::format("{} ({:.1f} us per row), {} down, {} up",
+			DRAW_LOD_NAMES[level], costPerRow[level] / 1000.0, stepsDown, stepsUp);
+	}
+
+	auto Reset(void) -> void {
+		stepsDown = 0;
+		stepsUp = 0;
+	}
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "stdafx.h"
+#include "RDFTransmissionTable.h"
+
+// Geographic drawing geometry shared read-only by screens with the same position settings
+// Built once per change of the drawn set (transmission generation, history window,
+// RX filter, position settings), screens only project and cull. Every LOD outline
+// is a subset of the full outline, so it is computed at one resolution.
+constexpr int GEOMETRY_VERTICES = 36; // outline points per row, bearing 360 * v / GEOMETRY_VERTICES
+
+// Draw settings that positions are resolved with, screens sharing them share geometry
+typedef std::array<int, 8> position_key; // see draw_settings::PositionKey
+
+typedef struct _draw_geometry {
+	TransmissionTable rows;
+	std::vector<EuroScopePlugIn::CPosition> outline; // GEOMETRY_VERTICES per row, clockwise from north
+	uint64_t build = 0; // unique per build
+	uint64_t generation = 0; // transmission generation the rows were taken from
+	int showSec = 0; // history window
+	bool rxOnly = false; // RX filter
+	std::vector<int> rxFrequencies; // RX on, kHz
+	position_key positionKey = {}; // settings the rows were resolved with
+	std::optional<std::chrono::steady_clock::time_point> expires; // first history row leaves window
+
+	auto Position(const size_t& row) const -> EuroScopePlugIn::CPosition {
+		EuroScopePlugIn::CPosition pos;
+		pos.m_Latitude = rows.latitude[row];
+		pos.m_Longitude = rows.longitude[row];
+		return pos;
+	}
+	auto Outline(const size_t& row, const int& vertex) const -> const EuroScopePlugIn::CPosition& {
+		return outline[row * GEOMETRY_VERTICES + vertex % GEOMETRY_VERTICES];
+	}
+	// vertex at bearing, bearing must be a multiple of 360 / GEOMETRY_VERTICES
+	auto OutlineAt(const size_t& row, const int& bearing) const -> const EuroScopePlugIn::CPosition& {
+		return Outline(row, bearing * GEOMETRY_VERTICES / 360);
+	}
+} draw_geometry;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "RDFTransmissionTable.h"
+
+// Bounded history of finished transmissions, newest last
+constexpr size_t HISTORY_CAPACITY = 256; // transmissions
+constexpr auto HISTORY_DEFAULT_SEC = 30; // .RDF HISTORY default and RDF state tag window
+
+typedef struct _history_entry {
+	inline_callsign callsign;
+	uint32_t id = 0; // interned callsign, held by TransmissionHistory while in ring
+	position_sample sample; // resolved per screen like live rows
+	int frequency = 0; // kHz, 0 if unknown (Audio for VATSIM standalone client)
+	std::chrono::steady_clock::time_point start;
+	std::chrono::steady_clock::time_point end;
+	bool overlapped = false; // see TX_FLAG_OVERLAP
+} history_entry;
+
+class TransmissionHistory
+{
+	// not thread safe, guarded by mtxTransmission
+private:
+	std::array<history_entry, HISTORY_CAPACITY> ring;
+	size_t head = 0; // next write
+	size_t count = 0;
+	CallsignInterner& ids; // shared with the transmission table, one reference per entry
+	std::vector<std::chrono::steady_clock::time_point> lastEnd; // ID -> end of latest entry in ring, epoch if none
+
+public:
+	TransmissionHistory(CallsignInterner& ids) :
+		ids(ids)
+	{
+	};
+
+	auto Push(history_entry&& entry) -> void {
+		// entries arrive in order of end time, oldest is overwritten when full
+		history_entry& slot = ring[head];
+		if (count == ring.size()) {
+			if (lastEnd[slot.id] == slot.end) {
+				lastEnd[slot.id] = {};
+			}
+			ids.Release(slot.id);
+		}
+		else {
+			count++;
+		}
+		slot = std::move(entry);
+		slot.id = ids.Acquire(slot.callsign);
+		if (slot.id >= lastEnd.size()) {
+			lastEnd.resize(slot.id + 1);
+		}
+		lastEnd[slot.id] = slot.end;
+		head = (head + 1) % ring.size();
+	}
+
+	// visits entries that ended at or after since, newest first, O(k)
+	auto ForEachSince(const std::chrono::steady_clock::time_point& since, const auto& func) const -> void {
+		for (size_t i = 0; i < count; i++) {
+			const history_entry& entry = ring[(head + ring.size() - 1 - i) % ring.size()];
+			if (entry.end < since) break;
+			func(entry);
+		}
+	}
+
+	auto LastEnd(const inline_callsign& callsign) const -> std::optional<std::chrono::steady_clock::time_point> {
+		auto id = ids.Find(callsign);
+		if (!id || lastEnd[*id] == std::chrono::steady_clock::time_point()) return std::nullopt;
+		return lastEnd[*id];
+	}
+
+	auto Clear(void) -> void {
+		ForEachSince(std::chrono::steady_clock::time_point(), [&](const history_entry& entry) {
+			lastEnd[entry.id] = {};
+			ids.Release(entry.id);
+			});
+		head = 0;
+		count = 0;
+	}
+
+	// callsigns in ring, bounded by HISTORY_CAPACITY
+	auto Callsigns(void) const -> size_t {
+		return ids.Size();
+	}
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Cached RDF overlay layer
+// OnRefresh draws through LayerRasterizer and only re-renders when the layer key
+// (drawn rows, drawing settings, view transform, level of detail) changes. The
+// surface, key and cache use no GDI types; GdiLayerRasterizer (RDFLayerGdi.h)
+// is the Windows surface, RDFPluginTest draws into a recording one.
+typedef uint32_t layer_color; // 0x00BBGGRR, same layout as COLORREF
+constexpr layer_color LAYER_COLOR_KEY = 0x00FF00FF; // transparent in layer
+constexpr layer_color LAYER_COLOR_KEY_ALT = 0x00FE00FE; // if a pen uses LAYER_COLOR_KEY
+constexpr int LAYER_FONT_HEIGHT = 14; // px, labels
+
+typedef struct _layer_point {
+	int x;
+	int y;
+} layer_point;
+
+// color key that no pen uses
+inline auto LayerColorKey(const layer_color& rgb, const layer_color& concurRGB) -> layer_color {
+	return (rgb == LAYER_COLOR_KEY || concurRGB == LAYER_COLOR_KEY) ? LAYER_COLOR_KEY_ALT : LAYER_COLOR_KEY;
+}
+
+class LayerRasterizer
+{
+public:
+	virtual ~LayerRasterizer(void) = default;
+	// clears the layer, which spans from the origin to width x height in target pixels
+	virtual auto Begin(const int& width, const int& height, const layer_color& rgb, const layer_color& concurRGB) -> void = 0;
+	virtual auto SelectPen(const bool& concurrent) -> void = 0;
+	virtual auto Polygon(const layer_point* points, const int& count) -> void = 0;
+	virtual auto Ellipse(const int& left, const int& top, const int& right, const int& bottom) -> void = 0;
+	virtual auto Line(const layer_point& from, const layer_point& to) -> void = 0;
+	virtual auto Text(const layer_point& anchor, const std::string_view& text) -> void = 0; // centred, pen color
+	virtual auto End(void) -> void = 0;
+};
+
+// FNV-1a over the values that decide what the layer looks like
+class LayerKey
+{
+private:
+	uint64_t hash = 14695981039346656037ULL;
+
+public:
+	template<class T>
+	auto Add(const T& value) -> void {
+		static_assert(std::is_trivially_copyable_v<T>);
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		for (size_t i = 0; i < sizeof(T); i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+	template<class T>
+	auto Add(const std::vector<T>& values) -> void {
+		Add(values.size());
+		for (const auto& v : values) {
+			Add(v);
+		}
+	}
+	auto Value(void) const -> uint64_t {
+		return hash;
+	}
+};
+
+class LayerCache
+{
+private:
+	std::optional<uint64_t> key;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+
+public:
+	// true if the layer rendered for key is still valid, otherwise caller re-renders
+	auto Hit(const uint64_t& newKey) -> bool {
+		if (key == newKey) {
+			hits++;
+			return true;
+		}
+		key = newKey;
+		misses++;
+		return false;
+	}
+	auto Invalidate(void) -> void {
+		key.reset();
+	}
+	auto Summary(void) const -> std::string {
+		return std::to_string(hits) + " hits, " + std::to_string(misses) + " renders";
+	}
+	auto Reset(void) -> void {
+		hits = 0;
+		misses = 0;
+	}
+};
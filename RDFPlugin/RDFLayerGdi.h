@@ -0,0 +1,178 @@
+#pragma once
+
+#include "stdafx.h"
+#include "RDFLayer.h"
+
+// GDI surface of the RDF layer, 32 bpp DIB section with color key, composited with TransparentBlt
+// Labels are drawn without antialiasing, blended edges would not match the color key.
+class GdiLayerRasterizer : public LayerRasterizer
+{
+private:
+	HDC memDC = NULL;
+	HBITMAP bitmap = NULL;
+	HGDIOBJ oldBitmap = NULL;
+	HGDIOBJ oldPen = NULL;
+	HGDIOBJ oldBrush = NULL;
+	HGDIOBJ oldFont = NULL;
+	HPEN pen = NULL;
+	HPEN penConcur = NULL;
+	HFONT font = NULL;
+	HBRUSH brushKey = NULL;
+	int width = 0;
+	int height = 0;
+	COLORREF colorKey = LAYER_COLOR_KEY;
+	COLORREF colorPen = 0;
+	COLORREF colorPenConcur = 0;
+	COLORREF colorText = 0;
+	RECT bounds = { 0, 0, 0, 0 }; // drawn area, empty if right <= left
+	std::vector<POINT> vertices; // Polygon buffer
+
+	auto Grow(const int& left, const int& top, const int& right, const int& bottom) -> void {
+		// pen is 1 px, right/bottom exclusive
+		RECT r = { max(left - 1, 0), max(top - 1, 0), min(right + 2, width), min(bottom + 2, height) };
+		if (r.right <= r.left || r.bottom <= r.top) return;
+		if (bounds.right <= bounds.left) {
+			bounds = r;
+			return;
+		}
+		bounds.left = min(bounds.left, r.left);
+		bounds.top = min(bounds.top, r.top);
+		bounds.right = max(bounds.right, r.right);
+		bounds.bottom = max(bounds.bottom, r.bottom);
+	}
+
+	auto Release(void) -> void {
+		if (memDC != NULL) {
+			SelectObject(memDC, oldPen);
+			SelectObject(memDC, oldBrush);
+			SelectObject(memDC, oldFont);
+			SelectObject(memDC, oldBitmap);
+			DeleteDC(memDC);
+			memDC = NULL;
+		}
+		for (HGDIOBJ obj : { (HGDIOBJ)bitmap, (HGDIOBJ)pen, (HGDIOBJ)penConcur, (HGDIOBJ)brushKey }) {
+			if (obj != NULL) {
+				DeleteObject(obj);
+			}
+		}
+		bitmap = NULL;
+		pen = NULL;
+		penConcur = NULL;
+		brushKey = NULL;
+		width = 0;
+		height = 0;
+	}
+
+public:
+	~GdiLayerRasterizer(void) {
+		Release();
+		if (font != NULL) {
+			DeleteObject(font);
+		}
+	}
+
+	auto Begin(const int& layerWidth, const int& layerHeight, const layer_color& rgb, const layer_color& concurRGB) -> void override {
+		int w = max(layerWidth, 1), h = max(layerHeight, 1);
+		COLORREF key = LayerColorKey(rgb, concurRGB);
+		if (memDC == NULL || w != width || h != height || key != colorKey) {
+			Release();
+			memDC = CreateCompatibleDC(NULL); // screen compatible, the DIB section fixes the format
+			BITMAPINFO bmi = {};
+			bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+			bmi.bmiHeader.biWidth = w;
+			bmi.bmiHeader.biHeight = -h; // top-down
+			bmi.bmiHeader.biPlanes = 1;
+			bmi.bmiHeader.biBitCount = 32;
+			bmi.bmiHeader.biCompression = BI_RGB;
+			void* bits = nullptr;
+			bitmap = CreateDIBSection(memDC, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+			oldBitmap = SelectObject(memDC, bitmap);
+			oldBrush = SelectObject(memDC, GetStockObject(HOLLOW_BRUSH));
+			if (font == NULL) {
+				font = CreateFont(LAYER_FONT_HEIGHT, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+					OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, NONANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "EuroScope");
+			}
+			oldFont = SelectObject(memDC, font);
+			SetBkMode(memDC, TRANSPARENT);
+			SetTextAlign(memDC, TA_CENTER | TA_BASELINE);
+			width = w;
+			height = h;
+			colorKey = key;
+			brushKey = CreateSolidBrush(colorKey);
+			RECT all = { 0, 0, width, height };
+			FillRect(memDC, &all, brushKey);
+			bounds = { 0, 0, 0, 0 };
+		}
+		else if (bounds.right > bounds.left) {
+			// only the previously drawn area needs clearing
+			FillRect(memDC, &bounds, brushKey);
+			bounds = { 0, 0, 0, 0 };
+		}
+		if (pen == NULL || rgb != colorPen || concurRGB != colorPenConcur) {
+			HPEN newPen = CreatePen(PS_SOLID, 1, rgb);
+			HPEN newPenConcur = CreatePen(PS_SOLID, 1, concurRGB);
+			HGDIOBJ prev = SelectObject(memDC, newPen);
+			if (pen == NULL) {
+				oldPen = prev;
+			}
+			else {
+				DeleteObject(pen);
+				DeleteObject(penConcur);
+			}
+			pen = newPen;
+			penConcur = newPenConcur;
+			colorPen = rgb;
+			colorPenConcur = concurRGB;
+		}
+		SelectPen(false);
+	}
+
+	auto SelectPen(const bool& concurrent) -> void override {
+		SelectObject(memDC, concurrent ? penConcur : pen);
+		colorText = concurrent ? colorPenConcur : colorPen;
+	}
+
+	auto Polygon(const layer_point* points, const int& count) -> void override {
+		if (count <= 0) return;
+		int left = points[0].x, top = points[0].y, right = points[0].x, bottom = points[0].y;
+		vertices.resize(count);
+		for (int i = 0; i < count; i++) {
+			left = min(left, points[i].x);
+			top = min(top, points[i].y);
+			right = max(right, points[i].x);
+			bottom = max(bottom, points[i].y);
+			vertices[i] = { points[i].x, points[i].y };
+		}
+		::Polygon(memDC, vertices.data(), count);
+		Grow(left, top, right, bottom);
+	}
+
+	auto Ellipse(const int& left, const int& top, const int& right, const int& bottom) -> void override {
+		::Ellipse(memDC, left, top, right, bottom);
+		Grow(min(left, right), min(top, bottom), max(left, right), max(top, bottom));
+	}
+
+	auto Line(const layer_point& from, const layer_point& to) -> void override {
+		MoveToEx(memDC, from.x, from.y, NULL);
+		LineTo(memDC, to.x, to.y);
+		Grow(min(from.x, to.x), min(from.y, to.y), max(from.x, to.x), max(from.y, to.y));
+	}
+
+	auto Text(const layer_point& anchor, const std::string_view& text) -> void override {
+		SetTextColor(memDC, colorText);
+		TextOut(memDC, anchor.x, anchor.y, text.data(), (int)text.size());
+		int half = LAYER_FONT_HEIGHT * (int)text.size() / 2 + 1; // generous, avoids measuring
+		Grow(anchor.x - half, anchor.y - LAYER_FONT_HEIGHT, anchor.x + half, anchor.y + LAYER_FONT_HEIGHT / 2);
+	}
+
+	auto End(void) -> void override {
+		GdiFlush();
+	}
+
+	// draws the layer onto the target, as often as needed
+	auto Composite(HDC target) -> void {
+		if (memDC == NULL || bounds.right <= bounds.left) return;
+		int w = bounds.right - bounds.left, h = bounds.bottom - bounds.top;
+		TransparentBlt(target, bounds.left, bounds.top, w, h, memDC, bounds.left, bounds.top, w, h, colorKey);
+	}
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "stdafx.h"
+#include <fstream>
+#include <plog/Converters/UTF8Converter.h>
+
+// Asynchronous plog appender, producers format into a bounded lock-free ring
+// and a writer thread does all file I/O. Records are dropped when the ring is full.
+// Formatter output is util::nstring (wide on Windows), Converter turns it into
+// file bytes, same template parameters as plog::RollingFileAppender.
+constexpr size_t LOG_RING_CAPACITY = 4096; // records, power of two
+constexpr auto LOG_FLUSH_INTERVAL = std::chrono::milliseconds(20);
+
+template<class Formatter, class Converter = plog::UTF8Converter>
+class AsyncLogAppender : public plog::IAppender
+{
+private:
+	typedef struct _log_slot {
+		std::atomic_size_t sequence = 0;
+		std::string text;
+	} log_slot;
+
+	// bounded MPSC queue (Vyukov), slot sequence tells producers and writer who owns it
+	std::array<log_slot, LOG_RING_CAPACITY> ring;
+	alignas(64) std::atomic_size_t posEnqueue = 0;
+	alignas(64) size_t posDequeue = 0; // writer thread only
+	std::atomic_uint64_t dropped = 0;
+	std::atomic_bool active = false;
+
+	std::filesystem::path path;
+	size_t maxFileSize;
+	int maxFiles;
+	size_t fileSize = 0;
+	std::ofstream file;
+	std::jthread threadWriter;
+
+	auto Enqueue(std::string&& text) -> bool {
+		size_t pos = posEnqueue.load(std::memory_order_relaxed);
+		log_slot* slot;
+		while (true) {
+			slot = &ring[pos & (LOG_RING_CAPACITY - 1)];
+			size_t seq = slot->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (posEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0) {
+				return false; // full
+			}
+			else {
+				pos = posEnqueue.load(std::memory_order_relaxed);
+			}
+		}
+		slot->text = std::move(text);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	auto Dequeue(std::string& text) -> bool {
+		log_slot& slot = ring[posDequeue & (LOG_RING_CAPACITY - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != posDequeue + 1) return false;
+		text.swap(slot.text);
+		slot.text.clear();
+		slot.sequence.store(posDequeue + LOG_RING_CAPACITY, std::memory_order_release);
+		posDequeue++;
+		return true;
+	}
+
+	auto OpenFile(void) -> void {
+		// same layout as plog::RollingFileAppender, RDFPlugin.log -> RDFPlugin.1.log
+		file.open(path, std::ios::binary | std::ios::app);
+		std::error_code ec;
+		auto size = std::filesystem::file_size(path, ec); // tellp of an append stream is 0 until the first write on MSVC
+		fileSize = file.is_open() && !ec ? (size_t)size : 0;
+		if (file.is_open() && !fileSize) {
+			WriteText(Converter::header(Formatter::header()));
+		}
+	}
+
+	auto RollFile(void) -> void {
+		// maxFiles counts the current file, as in plog
+		file.close();
+		std::error_code ec;
+		std::filesystem::remove(RolledPath(maxFiles - 1), ec);
+		for (int i = maxFiles - 2; i >= 0; i--) {
+			std::filesystem::rename(RolledPath(i), RolledPath(i + 1), ec);
+		}
+		OpenFile();
+	}
+
+	auto RolledPath(const int& index) const -> std::filesystem::path {
+		if (!index) return path;
+		std::filesystem::path rolled = path;
+		rolled.replace_extension(std::to_string(index) + path.extension().string());
+		return rolled;
+	}
+
+	auto WriteText(const std::string& text) -> void {
+		if (!file.is_open()) return;
+		if (maxFileSize && maxFiles > 0 && fileSize && fileSize + text.size() > maxFileSize) {
+			RollFile();
+			if (!file.is_open()) return;
+		}
+		file.write(text.data(), text.size());
+		fileSize += text.size();
+	}
+
+	auto Drain(void) -> bool {
+		std::string text;
+		bool any = false;
+		while (Dequeue(text)) {
+			WriteText(text);
+			any = true;
+		}
+		return any;
+	}
+
+	auto WriterLoop(std::stop_token stop) -> void {
+		uint64_t droppedReported = 0;
+		while (!stop.stop_requested()) {
+			bool any = Drain();
+			uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+			if (droppedNow != droppedReported) {
+				WriteText(std::format("[AsyncLogAppender] {} log records dropped, ring full\n", droppedNow - droppedReported));
+				droppedReported = droppedNow;
+				any = true;
+			}
+			if (any) {
+				file.flush();
+			}
+			else {
+				std::this_thread::sleep_for(LOG_FLUSH_INTERVAL);
+			}
+		}
+		Drain();
+		file.flush();
+	}
+
+public:
+	AsyncLogAppender(const std::filesystem::path& _path, const size_t& _maxFileSize = 0, const int& _maxFiles = 0) :
+		path(_path),
+		maxFileSize(_maxFileSize),
+		maxFiles(_maxFiles)
+	{
+		for (size_t i = 0; i < ring.size(); i++) {
+			ring[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~AsyncLogAppender(void) {
+		Stop();
+	}
+
+	virtual auto write(const plog::Record& record) -> void override {
+		// called from any logging thread, formats here and never touches the file
+		if (!active.load(std::memory_order_acquire) || !Enqueue(Converter::convert(Formatter::format(record)))) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	auto Start(void) -> void {
+		if (threadWriter.joinable()) return;
+		OpenFile();
+		active = true;
+		threadWriter = std::jthread(std::bind_front(&AsyncLogAppender::WriterLoop, this));
+	}
+
+	auto Stop(void) -> void {
+		// flushes everything queued so far, later records are counted as dropped
+		if (!threadWriter.joinable()) return;
+		active = false;
+		threadWriter.request_stop();
+		threadWriter.join();
+		file.close();
+	}
+
+	auto Dropped(void) const -> uint64_t {
+		return dropped.load(std::memory_order_relaxed);
+	}
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "stdafx.h"
+#include <bit>
+
+// In-process metrics, all updates are lock-free and relaxed
+constexpr auto METRICS_LOG_INTERVAL_SEC = 300;
+constexpr size_t METRICS_SUB_BUCKETS = 8; // per power of two, <= 12.5% relative error
+constexpr size_t METRICS_BUCKETS = (64 - 2) * METRICS_SUB_BUCKETS;
+
+class MetricCounter
+{
+private:
+	std::atomic_uint64_t value = 0;
+
+public:
+	auto Add(const uint64_t& n = 1) -> void {
+		value.fetch_add(n, std::memory_order_relaxed);
+	}
+	auto Get(void) const -> uint64_t {
+		return value.load(std::memory_order_relaxed);
+	}
+	auto Reset(void) -> void {
+		value.store(0, std::memory_order_relaxed);
+	}
+};
+
+class MetricHistogram
+{
+	// log-linear (HDR-style) histogram of nanoseconds
+private:
+	std::array<std::atomic_uint64_t, METRICS_BUCKETS> buckets = {};
+	std::atomic_uint64_t count = 0;
+	std::atomic_uint64_t sum = 0;
+	std::atomic_uint64_t maximum = 0;
+
+	static auto BucketIndex(const uint64_t& v) -> size_t {
+		if (v < METRICS_SUB_BUCKETS) return (size_t)v;
+		size_t msb = std::bit_width(v) - 1;
+		return (msb - 2) * METRICS_SUB_BUCKETS + ((v >> (msb - 3)) & (METRICS_SUB_BUCKETS - 1));
+	}
+	static auto BucketLowerBound(const size_t& index) -> uint64_t {
+		if (index < METRICS_SUB_BUCKETS) return index;
+		size_t msb = index / METRICS_SUB_BUCKETS + 2;
+		return (METRICS_SUB_BUCKETS + index % METRICS_SUB_BUCKETS) << (msb - 3);
+	}
+
+public:
+	auto Record(const uint64_t& ns) -> void {
+		buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(ns, std::memory_order_relaxed);
+		uint64_t prev = maximum.load(std::memory_order_relaxed);
+		while (prev < ns && !maximum.compare_exchange_weak(prev, ns, std::memory_order_relaxed));
+	}
+	auto Record(const std::chrono::steady_clock::duration& d) -> void {
+		Record((uint64_t)max(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(), 0LL));
+	}
+	auto Count(void) const -> uint64_t {
+		return count.load(std::memory_order_relaxed);
+	}
+	auto Sum(void) const -> uint64_t {
+		return sum.load(std::memory_order_relaxed);
+	}
+	auto Max(void) const -> uint64_t {
+		return maximum.load(std::memory_order_relaxed);
+	}
+	auto Percentile(const double& p) const -> uint64_t {
+		uint64_t total = Count();
+		if (!total) return 0;
+		uint64_t rank = (uint64_t)ceil(p * total), seen = 0;
+		for (size_t i = 0; i < buckets.size(); i++) {
+			seen += buckets[i].load(std::memory_order_relaxed);
+			if (seen >= rank && seen) return BucketLowerBound(i);
+		}
+		return Max();
+	}
+	auto Summary(void) const -> std::string { // in us
+		return std::format("n {}, p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us",
+			Count(), Percentile(0.5) / 1000.0, Percentile(0.99) / 1000.0, Max() / 1000.0);
+	}
+	auto Reset(void) -> void {
+		for (auto& b : buckets) {
+			b.store(0, std::memory_order_relaxed);
+		}
+		count.store(0, std::memory_order_relaxed);
+		sum.store(0, std::memory_order_relaxed);
+		maximum.store(0, std::memory_order_relaxed);
+	}
+};
+
+class ScopedMetricTimer
+{
+	// records lifetime of scope into histogram
+private:
+	MetricHistogram& histogram;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	ScopedMetricTimer(MetricHistogram& _histogram) :
+		histogram(_histogram),
+		start(std::chrono::steady_clock::now())
+	{
+	};
+	~ScopedMetricTimer(void) {
+		histogram.Record(std::chrono::steady_clock::now() - start);
+	};
+};
+
+// acquires lock and records time spent waiting for it
+template<class Lock, class Mutex>
+inline static auto TimedLock(Mutex& mutex, MetricHistogram& histogram) -> Lock {
+	auto start = std::chrono::steady_clock::now();
+	Lock lock(mutex);
+	histogram.Record(std::chrono::steady_clock::now() - start);
+	return lock;
+}
+
+enum ws_frame_type : size_t {
+	WS_FRAME_RX_BEGIN = 0,
+	WS_FRAME_RX_END,
+	WS_FRAME_STATION_STATE_UPDATE,
+	WS_FRAME_STATION_STATES,
+	WS_FRAME_OTHER,
+	WS_FRAME_TYPES
+};
+constexpr std::array<const char*, WS_FRAME_TYPES> WS_FRAME_NAMES = { "kRxBegin", "kRxEnd", "kStationStateUpdate", "kStationStates", "other" };
+
+typedef struct _plugin_metrics {
+	std::chrono::steady_clock::time_point timeReset = std::chrono::steady_clock::now();
+	std::array<MetricCounter, WS_FRAME_TYPES> wsFrames;
+	MetricCounter afvRDFMessages;
+	MetricCounter afvBridgeMessages;
+	MetricCounter replayDropped; // live audio client messages dropped while replaying
+	MetricCounter drawPositionCalls;
+	MetricCounter drawPositionFailures; // unresolved callsigns or filtered
+	MetricCounter channelToggles;
+	MetricCounter tagItemCalls;
+	MetricCounter refreshRequests; // transmission set changed
+	MetricCounter refreshPosted; // WM_RDF_REFRESH posted after coalescing
+	MetricCounter transmissionsExpired; // dropped by SETTING_MAX_TRANSMISSION
+	MetricCounter transmissionOverlaps; // began while another was active on the same frequency
+	MetricCounter geometryBuilds; // draw geometry computed
+	MetricCounter geometryShared; // draw geometry reused by a screen
+	MetricCounter stationUpdates; // kStationStateUpdate held for coalescing
+	MetricCounter stationUpdatesSuperseded; // replaced by a later update of the same station
+	MetricCounter stationUpdatesApplied; // final states applied to EuroScope channels
+	MetricHistogram waitTransmission; // lock wait on mtxTransmission
+	MetricHistogram rxParse; // received -> parsed
+	MetricHistogram rxPosition; // parsed -> position generated
+	MetricHistogram rxPublish; // position generated -> published
+	MetricHistogram rxFirstDraw; // published -> first OnRefresh that drew it
+	MetricHistogram rxTotal; // received -> first drawn
+
+	auto Reset(void) -> void {
+		timeReset = std::chrono::steady_clock::now();
+		for (auto& c : wsFrames) {
+			c.Reset();
+		}
+		afvRDFMessages.Reset();
+		afvBridgeMessages.Reset();
+		replayDropped.Reset();
+		drawPositionCalls.Reset();
+		drawPositionFailures.Reset();
+		channelToggles.Reset();
+		tagItemCalls.Reset();
+		refreshRequests.Reset();
+		refreshPosted.Reset();
+		transmissionsExpired.Reset();
+		transmissionOverlaps.Reset();
+		geometryBuilds.Reset();
+		geometryShared.Reset();
+		stationUpdates.Reset();
+		stationUpdatesSuperseded.Reset();
+		stationUpdatesApplied.Reset();
+		waitTransmission.Reset();
+		rxParse.Reset();
+		rxPosition.Reset();
+		rxPublish.Reset();
+		rxFirstDraw.Reset();
+		rxTotal.Reset();
+	}
+} plugin_metrics;
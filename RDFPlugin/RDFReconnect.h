@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <random>
+
+// TrackAudio reconnection backoff and liveness probe
+// ixwebsocket sleeps for the wait set after each error, exponential backoff with
+// equal jitter is set from the WS thread. While the wait is long, the EuroScope
+// thread probes the local endpoint with a cheap TCP connect (RDFReconnectProbe.h),
+// one probe at a time, and restarts the socket itself when the endpoint is back.
+constexpr auto TRACKAUDIO_RECONNECT_MIN_MS = 250; // first retry
+constexpr auto TRACKAUDIO_RECONNECT_MAX_MS = 4000; // backoff cap
+constexpr auto TRACKAUDIO_PROBE_MIN_WAIT_MS = 1000; // probe only while ixwebsocket sleeps longer than this
+
+class ReconnectPolicy
+{
+private:
+	std::atomic_uint32_t wait = TRACKAUDIO_RECONNECT_MIN_MS; // ms, current reconnection backoff
+	std::atomic_bool probing = false; // set from BeginProbe until EndProbe
+
+public:
+	// capped low so a restarted TrackAudio is found quickly
+	static auto Delay(const uint32_t& retries) -> uint32_t {
+		static thread_local std::mt19937 rdGenerator(std::random_device{}());
+		uint32_t base = TRACKAUDIO_RECONNECT_MAX_MS;
+		if (retries < 16) {
+			base = (std::min)((uint32_t)TRACKAUDIO_RECONNECT_MIN_MS << retries, (uint32_t)TRACKAUDIO_RECONNECT_MAX_MS);
+		}
+		std::uniform_int_distribution<uint32_t> disJitter(base / 2, base);
+		return disJitter(rdGenerator);
+	}
+
+	// on connection and on a new endpoint, return the wait for ixwebsocket
+	auto Reset(void) -> uint32_t {
+		wait = TRACKAUDIO_RECONNECT_MIN_MS;
+		return TRACKAUDIO_RECONNECT_MIN_MS;
+	}
+
+	// WS thread, on error
+	auto Failed(const uint32_t& retries) -> uint32_t {
+		// ixwebsocket has already scheduled the current wait, this sets the next one
+		uint32_t delay = Delay(retries);
+		wait = delay;
+		return delay;
+	}
+
+	auto Wait(void) const -> uint32_t {
+		return wait;
+	}
+
+	// true if the caller owns the next probe, it must call EndProbe once done
+	auto BeginProbe(void) -> bool {
+		if (wait <= TRACKAUDIO_PROBE_MIN_WAIT_MS) return false;
+		return !probing.exchange(true);
+	}
+
+	auto EndProbe(void) -> void {
+		probing = false;
+	}
+
+	auto Probing(void) const -> bool {
+		return probing;
+	}
+};
+
+// Drives the reconnection of one WebSocket, Socket is ix::WebSocket or a test double
+// Reset and Failed run on the WS thread, Tick and Restart on the EuroScope thread.
+template<class Socket>
+class ReconnectDriver
+{
+private:
+	Socket& socket;
+	ReconnectPolicy policy;
+	std::future<void> futureProbe; // EuroScope thread only
+
+public:
+	ReconnectDriver(Socket& socket) : socket(socket) {}
+
+	~ReconnectDriver(void) {
+		Join();
+	}
+
+	// on connection and on a new endpoint
+	auto Reset(void) -> void {
+		socket.setMinWaitBetweenReconnectionRetries(policy.Reset());
+		socket.setMaxWaitBetweenReconnectionRetries(TRACKAUDIO_RECONNECT_MIN_MS);
+	}
+
+	// on error
+	auto Failed(const uint32_t& retries) -> void {
+		uint32_t delay = policy.Failed(retries);
+		socket.setMinWaitBetweenReconnectionRetries(delay);
+		socket.setMaxWaitBetweenReconnectionRetries(delay);
+	}
+
+	// on timer, probe runs on its own task and returns true once it has posted the restart
+	// replacing a pending future would block in its destructor until the probe times out
+	auto Tick(const bool& closed, const std::function<bool(void)>& probe) -> void {
+		if (futureProbe.valid() && futureProbe.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+		if (closed && policy.BeginProbe()) {
+			futureProbe = std::async(std::launch::async, [this, probe]() {
+				if (!probe()) {
+					policy.EndProbe();
+				}
+				});
+		}
+	}
+
+	// posted restart, restarts the socket now instead of waiting for the backoff, true if restarted
+	auto Restart(const bool& closed) -> bool {
+		policy.EndProbe();
+		if (!closed) return false;
+		socket.stop();
+		socket.start();
+		return true;
+	}
+
+	// before the socket is stopped for good
+	auto Join(void) -> void {
+		if (futureProbe.valid()) {
+			futureProbe.wait();
+		}
+	}
+
+	auto Wait(void) const -> uint32_t {
+		return policy.Wait();
+	}
+
+	auto Probing(void) const -> bool {
+		return policy.Probing();
+	}
+};
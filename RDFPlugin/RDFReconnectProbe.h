@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <string>
+#include <ixwebsocket/IXCancellationRequest.h>
+#include <ixwebsocket/IXSocket.h>
+#include <ixwebsocket/IXSocketConnect.h>
+
+// TCP connect to host:port, true if something accepts, liveness probe of ReconnectDriver
+inline static auto ProbeEndpoint(const std::string& address, const int& timeoutSec) -> bool {
+	auto sep = address.rfind(':');
+	if (sep == std::string::npos) return false;
+	int port = 0;
+	if (std::from_chars(address.data() + sep + 1, address.data() + address.size(), port).ec != std::errc()) return false;
+	std::string errMsg;
+	std::atomic_bool requestCancel = false;
+	int fd = ix::SocketConnect::connect(address.substr(0, sep), port, errMsg,
+		ix::makeCancellationRequestWithTimeout(timeoutSec, requestCancel));
+	if (fd == -1) return false;
+	ix::Socket::closeSocket(fd);
+	return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Radar screens by slot, EuroScope thread only
+// Slots are reused once a screen is closed, so handles carry the slot generation
+// and a stale handle resolves to nothing. EuroScope owns the screens: a screen
+// closes its slot in OnAsrContentToBeClosed and then deletes itself as its last
+// action, as the EuroScope API requires. Every call runs on the EuroScope thread,
+// so nothing holds a screen across its deletion and the registry needs no lock.
+typedef struct _screen_handle {
+	int id = -1; // slot, -1 for plugin settings
+	uint32_t generation = 0;
+} screen_handle;
+
+template<class T>
+class ScreenRegistry
+{
+private:
+	typedef struct _screen_slot {
+		T* screen = nullptr; // not owned, null if free
+		uint32_t generation = 0; // bumped on close
+	} screen_slot;
+
+	std::vector<screen_slot> slots;
+	std::vector<int> freeSlots; // reused last in first out
+	uint64_t opened = 0;
+	uint64_t closed = 0;
+
+public:
+	// create(handle) -> T*, owned by the caller
+	auto Open(const auto& create) -> T* {
+		int id;
+		if (freeSlots.size()) {
+			id = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			id = (int)slots.size();
+			slots.emplace_back();
+		}
+		auto& slot = slots[id];
+		slot.screen = create(screen_handle{ id, slot.generation });
+		opened++;
+		return slot.screen;
+	}
+
+	// forgets the screen and frees its slot, returns false if the handle is stale
+	auto Close(const screen_handle& handle) -> bool {
+		if (Get(handle) == nullptr) return false;
+		auto& slot = slots[handle.id];
+		slot.screen = nullptr;
+		slot.generation++;
+		freeSlots.push_back(handle.id);
+		closed++;
+		return true;
+	}
+
+	// nullptr if closed or stale
+	auto Get(const screen_handle& handle) const -> T* {
+		if (handle.id < 0 || handle.id >= (int)slots.size()) return nullptr;
+		const auto& slot = slots[handle.id];
+		return slot.generation == handle.generation ? slot.screen : nullptr;
+	}
+
+	// func(T&) for every open screen
+	auto ForEach(const auto& func) const -> void {
+		for (const auto& slot : slots) {
+			if (slot.screen) {
+				func(*slot.screen);
+			}
+		}
+	}
+
+	auto Slots(void) const -> size_t {
+		return slots.size();
+	}
+
+	auto Summary(void) const -> std::string {
+		return std::to_string(slots.size() - freeSlots.size()) + " open, " + std::to_string(slots.size()) + " slots, "
+			+ std::to_string(opened) + " opened, " + std::to_string(closed) + " closed";
+	}
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "RDFCallsign.h"
+#include "RDFStationSync.h"
+
+// kStationStateUpdate coalescing, pushed on WS thread, popped on EuroScope thread
+// TrackAudio sends several updates per station within milliseconds when a position
+// is set up or it reconnects (RX, then TX, then XC). Updates are held per station
+// (callsign and frequency) for a short window after the first one, later updates
+// replace the held state, so channels are only toggled into the final state.
+// The kStationStates reconcile is held the same way and applied after the updates
+// popped with it, later updates keep its active frequencies current.
+constexpr auto STATION_UPDATE_WINDOW_MS = 50;
+
+enum station_push : int {
+	STATION_PUSH_FIRST = 0, // queue was empty, caller schedules a Pop
+	STATION_PUSH_HELD, // new station, a Pop is already scheduled
+	STATION_PUSH_SUPERSEDED // replaced the held state of the station
+};
+
+typedef struct _station_update {
+	inline_callsign callsign; // empty if TrackAudio did not report one
+	station_state state;
+	std::chrono::steady_clock::time_point first; // arrival of the first held update
+} station_update;
+
+typedef struct _station_batch {
+	std::vector<station_update> updates; // arrival order
+	std::optional<std::vector<int>> reconcile; // active frequencies in kHz, channels on none of them are switched off
+} station_batch;
+
+class StationUpdateQueue
+{
+private:
+	std::mutex mtx;
+	std::vector<station_update> pending; // arrival order, a handful of stations
+	std::optional<std::vector<int>> reconcile;
+	std::chrono::steady_clock::time_point reconcileFirst;
+
+	auto IsEmpty(void) const -> bool {
+		return pending.empty() && !reconcile;
+	}
+
+public:
+	auto Push(const inline_callsign& callsign, const station_state& state, const std::chrono::steady_clock::time_point& now) -> station_push {
+		std::lock_guard lock(mtx);
+		if (reconcile) {
+			auto& active = *reconcile;
+			auto near = std::find_if(active.begin(), active.end(), [&](const int& f) { return std::abs(f - state.frequency) <= STATION_SYNC_TOLERANCE_KHZ; });
+			if (state.rx || state.tx) {
+				if (near == active.end()) {
+					active.push_back(state.frequency);
+				}
+			}
+			else if (near != active.end()) {
+				active.erase(near);
+			}
+		}
+		for (auto& p : pending) {
+			if (p.state.frequency == state.frequency && p.callsign == callsign) {
+				p.state = state;
+				return STATION_PUSH_SUPERSEDED;
+			}
+		}
+		bool first = IsEmpty();
+		pending.push_back({ callsign, state, now });
+		return first ? STATION_PUSH_FIRST : STATION_PUSH_HELD;
+	}
+
+	// kStationStates, replaces a held reconcile but keeps its window
+	auto Reconcile(const std::vector<int>& active, const std::chrono::steady_clock::time_point& now) -> station_push {
+		std::lock_guard lock(mtx);
+		if (reconcile) {
+			reconcile = active;
+			return STATION_PUSH_SUPERSEDED;
+		}
+		bool first = IsEmpty();
+		reconcile = active;
+		reconcileFirst = now;
+		return first ? STATION_PUSH_FIRST : STATION_PUSH_HELD;
+	}
+
+	// moves everything whose window has passed into due, returns time until the next one
+	auto Pop(const std::chrono::steady_clock::time_point& now, station_batch& due) -> std::optional<std::chrono::steady_clock::duration> {
+		std::lock_guard lock(mtx);
+		auto window = std::chrono::milliseconds(STATION_UPDATE_WINDOW_MS);
+		std::optional<std::chrono::steady_clock::duration> next;
+		auto Hold = [&](const std::chrono::steady_clock::time_point& first) -> bool {
+			if (now - first >= window) return false;
+			auto left = first + window - now;
+			if (!next || left < *next) {
+				next = left;
+			}
+			return true;
+			};
+		auto kept = pending.begin();
+		for (auto& p : pending) {
+			if (!Hold(p.first)) {
+				due.updates.push_back(p);
+				continue;
+			}
+			*kept++ = p;
+		}
+		pending.erase(kept, pending.end());
+		if (reconcile && !Hold(reconcileFirst)) {
+			due.reconcile = std::move(reconcile);
+			reconcile.reset();
+		}
+		return next;
+	}
+
+	auto Clear(void) -> void {
+		std::lock_guard lock(mtx);
+		pending.clear();
+		reconcile.reset();
+	}
+};
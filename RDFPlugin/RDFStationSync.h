@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// EuroScope -> TrackAudio station sync (TrackAudioMode 2)
+// The mirror holds the last state both sides agreed on per frequency. Local channel
+// changes are diffed against it on the timer (skipped while the channel hash is
+// unchanged), coalesced per frequency and sent as one batch once they have settled.
+// Sent states are expected back as kStationStateUpdate; until then updates for that
+// frequency are echoes or stale intermediates and must not toggle EuroScope channels.
+constexpr auto STATION_SYNC_DEBOUNCE_MS = 500; // quiet time before a batch is sent
+constexpr auto STATION_SYNC_ECHO_MS = 3000; // how long a sent state is expected back
+constexpr auto STATION_SYNC_TOLERANCE_KHZ = 10; // as FrequencyIsSame
+
+typedef struct _station_state {
+	int frequency = 0; // kHz
+	bool rx = false;
+	bool tx = false;
+} station_state;
+
+class StationSync
+{
+private:
+	typedef struct _station_expect {
+		bool rx;
+		bool tx;
+		std::chrono::steady_clock::time_point deadline;
+	} station_expect;
+
+	std::mutex mtx; // Observe/Flush on EuroScope thread, Remote on WS thread
+	uint64_t hash = 0;
+	std::map<int, std::pair<bool, bool>> mirror; // kHz -> rx, tx
+	std::map<int, std::pair<bool, bool>> pending; // kHz -> local state not sent yet
+	std::map<int, station_expect> expected; // kHz -> sent state
+	std::chrono::steady_clock::time_point lastChange;
+	uint64_t changes = 0;
+	uint64_t coalesced = 0;
+	uint64_t commands = 0;
+	uint64_t batches = 0;
+	uint64_t echoes = 0;
+
+	// entry for the same frequency within tolerance, keys are TrackAudio frequencies once reported
+	template<class T>
+	static auto Near(std::map<int, T>& map, const int& frequency) -> typename std::map<int, T>::iterator {
+		auto it = map.lower_bound(frequency - STATION_SYNC_TOLERANCE_KHZ);
+		return it != map.end() && it->first <= frequency + STATION_SYNC_TOLERANCE_KHZ ? it : map.end();
+	}
+
+	static auto Hash(const std::vector<station_state>& channels) -> uint64_t {
+		uint64_t h = 14695981039346656037ULL;
+		for (const auto& c : channels) {
+			uint64_t v = ((uint64_t)(uint32_t)c.frequency << 2) | ((uint64_t)c.rx << 1) | (uint64_t)c.tx;
+			h = (h ^ v) * 1099511628211ULL;
+		}
+		return h;
+	}
+
+public:
+	// local channel states in EuroScope order, a frequency seen the first time is only mirrored
+	auto Observe(const std::vector<station_state>& channels, const std::chrono::steady_clock::time_point& now) -> void {
+		uint64_t h = Hash(channels);
+		std::lock_guard lock(mtx);
+		if (h == hash) return;
+		hash = h;
+		std::map<int, std::pair<bool, bool>> local; // channels sharing a frequency are one station
+		for (const auto& c : channels) {
+			auto& s = local[c.frequency];
+			s.first |= c.rx;
+			s.second |= c.tx;
+		}
+		for (const auto& [frequency, state] : local) {
+			auto m = Near(mirror, frequency);
+			if (m == mirror.end()) {
+				mirror.emplace(frequency, state);
+				continue;
+			}
+			auto p = pending.find(m->first);
+			if (m->second == state) {
+				if (p != pending.end()) { // reverted before it was sent
+					pending.erase(p);
+					coalesced++;
+				}
+				continue;
+			}
+			if (p != pending.end()) {
+				if (p->second == state) continue;
+				coalesced++;
+			}
+			pending[m->first] = state;
+			lastChange = now;
+			changes++;
+		}
+	}
+
+	// settled local changes to send, empty while changes keep coming
+	auto Flush(const std::chrono::steady_clock::time_point& now) -> std::vector<station_state> {
+		std::vector<station_state> batch;
+		std::lock_guard lock(mtx);
+		if (pending.empty() || now - lastChange < std::chrono::milliseconds(STATION_SYNC_DEBOUNCE_MS)) return batch;
+		for (const auto& [frequency, state] : pending) {
+			batch.push_back({ frequency, state.first, state.second });
+			mirror[frequency] = state;
+			expected[frequency] = { state.first, state.second, now + std::chrono::milliseconds(STATION_SYNC_ECHO_MS) };
+		}
+		pending.clear();
+		commands += batch.size();
+		batches++;
+		return batch;
+	}
+
+	// TrackAudio station update, returns false if it must not be applied to EuroScope
+	auto Remote(const station_state& state, const std::chrono::steady_clock::time_point& now) -> bool {
+		std::lock_guard lock(mtx);
+		auto e = Near(expected, state.frequency);
+		if (e != expected.end()) {
+			if (now < e->second.deadline) {
+				if (e->second.rx == state.rx && e->second.tx == state.tx) {
+					expected.erase(e); // our own command came back
+				}
+				echoes++;
+				return false;
+			}
+			expected.erase(e);
+		}
+		// TrackAudio wins over local changes not sent yet
+		if (auto p = Near(pending, state.frequency); p != pending.end()) {
+			pending.erase(p);
+		}
+		if (auto m = Near(mirror, state.frequency); m != mirror.end()) {
+			mirror.erase(m);
+		}
+		mirror[state.frequency] = { state.rx, state.tx };
+		return true;
+	}
+
+	auto Clear(void) -> void {
+		std::lock_guard lock(mtx);
+		hash = 0;
+		mirror.clear();
+		pending.clear();
+		expected.clear();
+	}
+
+	auto Summary(void) -> std::string {
+		std::lock_guard lock(mtx);
+		return std::to_string(changes) + " local changes, " + std::to_string(coalesced) + " coalesced, "
+			+ std::to_string(commands) + " commands in " + std::to_string(batches) + " batches, "
+			+ std::to_string(echoes) + " echoes suppressed";
+	}
+
+	auto Reset(void) -> void {
+		std::lock_guard lock(mtx);
+		changes = 0;
+		coalesced = 0;
+		commands = 0;
+		batches = 0;
+		echoes = 0;
+	}
+};
@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include "RDFCluster.h"
 
 struct rdf_style {
     std::string name;
@@ -15,6 +16,7 @@ struct rdf_style {
     std::string rdfRGB;
     std::string rdfConcurRGB;
     bool drawController;
+    int clusterOverlap; // optional, percent overlap to merge circles, negative disables
 };
 
 class StyleManager {
@@ -60,6 +62,7 @@ public:
                 style.rdfRGB = value["rdfRGB"];
                 style.rdfConcurRGB = value["rdfConcurRGB"];
                 style.drawController = value["drawController"];
+                style.clusterOverlap = value.value("clusterOverlap", CLUSTER_OVERLAP_DEFAULT);
 
                 styles[key] = style;
             }
@@ -86,7 +89,8 @@ public:
             {"highPrecision", 20},
             {"rdfRGB", "114:150:102"},
             {"rdfConcurRGB", "114:150:102"},
-            {"drawController", false}
+            {"drawController", false},
+            {"clusterOverlap", CLUSTER_OVERLAP_DEFAULT}
         };
 
         j["RING"] = {
@@ -100,7 +104,8 @@ public:
             {"highPrecision", 0},
             {"rdfRGB", "114:150:102"},
             {"rdfConcurRGB", "114:150:102"},
-            {"drawController", false}
+            {"drawController", false},
+            {"clusterOverlap", CLUSTER_OVERLAP_DEFAULT}
         };
 
         std::ofstream f(configPath);
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "RDFCallsign.h"
+
+// Lock-free index of recently transmitting callsigns for tag items
+// One writer at a time rebuilds the open-addressing table inside a generation
+// seqlock, readers probe with the precomputed callsign hash and retry if the
+// generation moved while they looked. A reader that keeps losing to the writer
+// falls back to waiting for the writer lock instead of spinning.
+// The transmission lock is only held to copy a flat tag_snapshot, aggregation
+// and publishing run after it is released. Snapshots are numbered, so one
+// that lost the race to a newer one is dropped.
+constexpr size_t TAG_INDEX_SLOTS = 1024; // power of two, half of it usable
+constexpr size_t TAG_CALLSIGN_WORDS = CALLSIGN_CAPACITY / sizeof(uint64_t);
+constexpr int TAG_INDEX_RETRIES = 64; // lock-free attempts before Find takes the writer lock
+
+typedef struct _tag_state {
+	bool transmitting = false;
+	std::optional<std::chrono::steady_clock::time_point> lastEnd; // latest finished transmission
+	uint32_t count = 0; // transmissions in window, as of last rebuild
+} tag_state;
+
+// one current transmission or history entry
+typedef struct _tag_source {
+	inline_callsign callsign;
+	uint32_t id; // interned callsign, aggregation key
+	std::optional<std::chrono::steady_clock::time_point> end; // none while transmitting
+} tag_source;
+
+typedef struct _tag_snapshot {
+	uint64_t sequence = 0; // taken under the transmission lock
+	std::chrono::steady_clock::time_point windowStart; // ends before it are not counted
+	std::vector<tag_source> sources;
+} tag_snapshot;
+
+class TagIndex
+{
+private:
+	typedef struct _tag_slot {
+		std::array<std::atomic_uint64_t, TAG_CALLSIGN_WORDS> key = {}; // all zero: empty
+		std::atomic_uint64_t ident = 0; // hash and length of full callsign, truncated keys may collide
+		std::atomic_int64_t lastEnd = 0; // steady_clock ns, 0 if none
+		std::atomic_uint32_t state = 0; // bit 0: transmitting, bits 1+: count
+	} tag_slot;
+
+	std::array<tag_slot, TAG_INDEX_SLOTS> slots;
+	std::atomic_uint64_t generation = 0; // odd while writing
+	mutable std::mutex mtxWriter; // serializes Publish, Find fallback
+	std::vector<size_t> used; // writer only, slots to clear on rebuild
+	uint64_t sequence = 0; // writer only, of the last published snapshot
+
+	typedef std::array<uint64_t, TAG_CALLSIGN_WORDS> inline_key;
+
+	static auto Pack(const inline_callsign& callsign, inline_key& key) -> bool {
+		if (callsign.Empty()) return false;
+		std::memcpy(key.data(), callsign.chars.data(), CALLSIGN_CAPACITY);
+		return true;
+	}
+
+	static auto Ident(const inline_callsign& callsign) -> uint64_t {
+		return ((uint64_t)callsign.hash << 32) | callsign.length;
+	}
+
+	static auto Nanoseconds(const std::chrono::steady_clock::time_point& time) -> int64_t {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+
+	// result is only valid if the generation did not move
+	auto Probe(const inline_callsign& callsign, const inline_key& key) const -> std::optional<tag_state> {
+		uint64_t ident = Ident(callsign);
+		size_t i = callsign.hash & (TAG_INDEX_SLOTS - 1);
+		for (size_t probe = 0; probe < TAG_INDEX_SLOTS; probe++, i = (i + 1) & (TAG_INDEX_SLOTS - 1)) {
+			const auto& slot = slots[i];
+			uint64_t k0 = slot.key[0].load(std::memory_order_relaxed);
+			if (!k0) break;
+			if (k0 != key[0] || slot.key[1].load(std::memory_order_relaxed) != key[1] || slot.ident.load(std::memory_order_relaxed) != ident) continue;
+			int64_t lastEnd = slot.lastEnd.load(std::memory_order_relaxed);
+			uint32_t state = slot.state.load(std::memory_order_relaxed);
+			tag_state ts;
+			ts.transmitting = state & 1;
+			ts.count = state >> 1;
+			if (lastEnd) {
+				ts.lastEnd = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(lastEnd)));
+			}
+			return ts;
+		}
+		return std::nullopt;
+	}
+
+public:
+	typedef std::vector<std::pair<inline_callsign, tag_state>> build_list; // unique callsigns
+
+	// one state per callsign ID, no lock needed
+	static auto Aggregate(const tag_snapshot& snapshot) -> build_list {
+		build_list states;
+		std::vector<uint32_t> stateOf; // ID -> index + 1
+		for (const auto& source : snapshot.sources) {
+			if (source.id >= stateOf.size()) {
+				stateOf.resize(source.id + 1);
+			}
+			if (!stateOf[source.id]) {
+				states.emplace_back(source.callsign, tag_state());
+				stateOf[source.id] = (uint32_t)states.size();
+			}
+			auto& state = states[stateOf[source.id] - 1].second;
+			if (!source.end) {
+				state.transmitting = true;
+				continue;
+			}
+			// whole history for last TX, window only for count
+			if (!state.lastEnd || *source.end > *state.lastEnd) {
+				state.lastEnd = source.end;
+			}
+			if (*source.end >= snapshot.windowStart) {
+				state.count++;
+			}
+		}
+		return states;
+	}
+
+	// writer, any thread, false if a later snapshot is already published
+	auto Publish(const build_list& states, const uint64_t& snapshot) -> bool {
+		std::lock_guard lock(mtxWriter);
+		if (snapshot < sequence) return false;
+		sequence = snapshot;
+		uint64_t gen = generation.load(std::memory_order_relaxed);
+		generation.store(gen + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (const auto& i : used) {
+			for (auto& w : slots[i].key) {
+				w.store(0, std::memory_order_relaxed);
+			}
+		}
+		used.clear();
+		for (const auto& [callsign, state] : states) {
+			inline_key key;
+			if (used.size() >= TAG_INDEX_SLOTS / 2 || !Pack(callsign, key)) continue;
+			size_t i = callsign.hash & (TAG_INDEX_SLOTS - 1);
+			while (slots[i].key[0].load(std::memory_order_relaxed)) {
+				i = (i + 1) & (TAG_INDEX_SLOTS - 1);
+			}
+			auto& slot = slots[i];
+			for (size_t w = 0; w < TAG_CALLSIGN_WORDS; w++) {
+				slot.key[w].store(key[w], std::memory_order_relaxed);
+			}
+			slot.ident.store(Ident(callsign), std::memory_order_relaxed);
+			slot.lastEnd.store(state.lastEnd ? Nanoseconds(*state.lastEnd) : 0, std::memory_order_relaxed);
+			slot.state.store((state.transmitting ? 1 : 0) | ((std::min)(state.count, 0x7fffffffU) << 1), std::memory_order_relaxed);
+			used.push_back(i);
+		}
+		generation.store(gen + 2, std::memory_order_release);
+		return true;
+	}
+
+	// reader, any thread, no allocation, lock only after TAG_INDEX_RETRIES lost races
+	auto Find(const inline_callsign& callsign) const -> std::optional<tag_state> {
+		inline_key key;
+		if (!Pack(callsign, key)) return std::nullopt;
+		for (int retry = 0; retry < TAG_INDEX_RETRIES; retry++) {
+			uint64_t gen = generation.load(std::memory_order_acquire);
+			if (gen & 1) { // writer active
+				std::this_thread::yield();
+				continue;
+			}
+			auto res = Probe(callsign, key);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (generation.load(std::memory_order_relaxed) == gen) return res;
+		}
+		std::lock_guard lock(mtxWriter); // no writer inside
+		return Probe(callsign, key);
+	}
+
+	auto Generation(void) const -> uint64_t {
+		return generation.load(std::memory_order_acquire) >> 1;
+	}
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Hashed timing wheel, O(1) schedule and O(1) amortized expiry per entry
+// Cancellation is lazy: entries are never removed early. The owner keeps the
+// tick returned by Schedule and ignores a fired entry whose tick it no longer
+// holds, e.g. after the key was freed and reused.
+constexpr size_t TIMER_WHEEL_SLOTS = 64; // power of two
+
+template<class Key>
+class TimerWheel
+{
+private:
+	typedef struct _wheel_entry {
+		Key key;
+		int64_t tick;
+	} wheel_entry;
+
+	std::array<std::vector<wheel_entry>, TIMER_WHEEL_SLOTS> slots;
+	int64_t current = 0; // last serviced tick
+	size_t pending = 0;
+
+public:
+	auto Size(void) const -> size_t {
+		return pending;
+	}
+
+	// returns the tick the entry fires at, never before the next one
+	auto Schedule(const Key& key, int64_t tick) -> int64_t {
+		tick = (std::max)(tick, current + 1);
+		slots[tick & (TIMER_WHEEL_SLOTS - 1)].push_back({ key, tick });
+		pending++;
+		return tick;
+	}
+
+	// fires all entries due up to tick, func(key, scheduled tick) is called once per scheduled entry
+	auto Advance(const int64_t& tick, const auto& func) -> void {
+		if (tick <= current) return;
+		int64_t first = tick - current >= (int64_t)TIMER_WHEEL_SLOTS ? tick - (int64_t)TIMER_WHEEL_SLOTS + 1 : current + 1;
+		current = tick;
+		if (!pending) return;
+		for (int64_t t = first; t <= tick; t++) {
+			auto& slot = slots[t & (TIMER_WHEEL_SLOTS - 1)];
+			for (size_t i = 0; i < slot.size();) {
+				if (slot[i].tick > tick) { // a later round
+					i++;
+					continue;
+				}
+				Key key = std::move(slot[i].key);
+				int64_t scheduled = slot[i].tick;
+				slot[i] = std::move(slot.back());
+				slot.pop_back();
+				pending--;
+				func(key, scheduled);
+			}
+		}
+	}
+
+	auto Clear(void) -> void {
+		for (auto& slot : slots) {
+			slot.clear();
+		}
+		pending = 0;
+	}
+
+	// clears and continues from tick, which may be earlier than the last serviced one
+	auto Restart(const int64_t& tick) -> void {
+		Clear();
+		current = tick;
+	}
+};
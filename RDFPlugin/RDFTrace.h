@@ -0,0 +1,150 @@
+#pragma once
+
+#include "stdafx.h"
+
+// Span tracing exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// Compiled out unless RDF_TRACE is defined, see README Developing section.
+#ifdef RDF_TRACE
+
+#include <fstream>
+
+constexpr size_t TRACE_BUFFER_EVENTS = 1 << 16; // per thread and session
+
+typedef struct _trace_event {
+	const char* name; // string literal
+	int64_t start; // ns since session start
+	int64_t duration; // ns
+} trace_event;
+
+class TraceBuffer
+{
+	// written only by its owning thread, read by exporter after count
+public:
+	uint32_t tid = 0;
+	std::atomic_uint32_t session = 0;
+	std::atomic_size_t count = 0;
+	std::atomic_uint64_t dropped = 0;
+	std::unique_ptr<trace_event[]> events;
+
+	auto Record(const uint32_t& currentSession, const trace_event& ev) -> void {
+		if (session.load(std::memory_order_relaxed) != currentSession) {
+			// first span of a new session on this thread, owner resets
+			if (!events) events = std::make_unique<trace_event[]>(TRACE_BUFFER_EVENTS);
+			count.store(0, std::memory_order_relaxed);
+			dropped.store(0, std::memory_order_relaxed);
+			session.store(currentSession, std::memory_order_release);
+		}
+		size_t n = count.load(std::memory_order_relaxed);
+		if (n >= TRACE_BUFFER_EVENTS) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		events[n] = ev;
+		count.store(n + 1, std::memory_order_release);
+	}
+};
+
+class TraceRecorder
+{
+private:
+	std::atomic_bool active = false;
+	std::atomic_uint32_t session = 0;
+	std::atomic_int64_t timeStart = 0; // steady_clock ns
+	std::mutex mtxBuffers; // only for thread registration and export
+	std::vector<std::shared_ptr<TraceBuffer>> buffers;
+
+	auto ThreadBuffer(void) -> TraceBuffer& {
+		thread_local std::shared_ptr<TraceBuffer> buffer;
+		if (!buffer) {
+			buffer = std::make_shared<TraceBuffer>();
+			buffer->tid = (uint32_t)GetCurrentThreadId();
+			std::unique_lock lock(mtxBuffers);
+			buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+public:
+	auto IsActive(void) const -> bool {
+		return active.load(std::memory_order_relaxed);
+	}
+
+	static auto Clock(void) -> int64_t {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	auto Now(void) const -> int64_t {
+		return Clock() - timeStart.load(std::memory_order_relaxed);
+	}
+
+	auto Record(const char* name, const int64_t& start, const int64_t& end) -> void {
+		if (!IsActive()) return;
+		ThreadBuffer().Record(session.load(std::memory_order_acquire), { name, start, end - start });
+	}
+
+	auto Start(void) -> void {
+		std::unique_lock lock(mtxBuffers);
+		// drop buffers of exited threads
+		std::erase_if(buffers, [](const auto& b) { return b.use_count() == 1; });
+		timeStart = Clock();
+		session.fetch_add(1, std::memory_order_release);
+		active = true;
+	}
+
+	// stops recording and writes the session, returns number of spans written
+	auto Stop(const std::filesystem::path& path, uint64_t& dropped) -> size_t {
+		active = false;
+		dropped = 0;
+		uint32_t current = session.load(std::memory_order_acquire);
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open()) return 0;
+		size_t written = 0;
+		file << "{\"traceEvents\":[";
+		std::unique_lock lock(mtxBuffers);
+		for (const auto& b : buffers) {
+			if (b->session.load(std::memory_order_acquire) != current) continue;
+			size_t n = b->count.load(std::memory_order_acquire);
+			dropped += b->dropped.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < n; i++) {
+				const auto& ev = b->events[i];
+				file << (written++ ? ",\n" : "\n") << std::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+					ev.name, b->tid, ev.start / 1000.0, ev.duration / 1000.0);
+			}
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		return written;
+	}
+};
+
+inline auto Tracer(void) -> TraceRecorder& {
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+class TraceSpan
+{
+	// records lifetime of scope as a complete event
+private:
+	const char* name;
+	int64_t start = 0;
+
+public:
+	TraceSpan(const char* _name) :
+		name(_name)
+	{
+		if (Tracer().IsActive()) start = Tracer().Now();
+		else name = nullptr;
+	};
+	~TraceSpan(void) {
+		if (name != nullptr) Tracer().Record(name, start, Tracer().Now());
+	};
+};
+
+#define RDF_TRACE_CONCAT_(a, b) a##b
+#define RDF_TRACE_CONCAT(a, b) RDF_TRACE_CONCAT_(a, b)
+#define RDF_TRACE_SCOPE(name) TraceSpan RDF_TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#else
+
+#define RDF_TRACE_SCOPE(name) ((void)0)
+
+#endif // RDF_TRACE
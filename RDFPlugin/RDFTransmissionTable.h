@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+#include "RDFCallsign.h"
+
+// RX latency trace, one timestamp per stage from audio client message to screen
+typedef struct _rx_trace {
+	std::chrono::steady_clock::time_point received; // WS frame / WM_COPYDATA
+	std::chrono::steady_clock::time_point parsed;
+	std::chrono::steady_clock::time_point positioned; // SamplePosition finished
+	std::chrono::steady_clock::time_point published; // visible to GetDrawGeometry
+} rx_trace;
+
+// Screen independent part of a draw position, sampled once per transmission
+// Each screen resolves it with its own altitude and precision settings, so the
+// random offset stays the same across screens and settings changes.
+typedef struct _position_sample {
+	double latitude = 0; // aircraft or controller, before offset
+	double longitude = 0;
+	int altitude = 0; // pressure altitude, feet
+	bool controller = false; // no radar target, position of controller
+	double bearing = 0; // degrees, of random offset
+	double spread = 0; // |N(0, 1)| / 3, random offset is spread * precision
+} position_sample;
+
+// Loosest drawing filter over all screen settings, a sample no screen would draw is not tracked
+typedef struct _track_filter {
+	int lowAltitude = (std::numeric_limits<int>::max)(); // feet, lowest of the screens
+	bool controller = false; // any screen draws controllers
+
+	auto Add(const int& screenLowAltitude, const bool& drawController) -> void {
+		lowAltitude = (std::min)(lowAltitude, screenLowAltitude);
+		controller = controller || drawController;
+	}
+
+	auto Tracks(const position_sample& sample) const -> bool {
+		return sample.controller ? controller : sample.altitude >= lowAltitude;
+	}
+} track_filter;
+
+// Draw position, one transmission before it enters the table
+typedef struct _draw_position {
+	position_sample sample;
+	rx_trace trace;
+	std::chrono::steady_clock::time_point started; // on the transmission clock, see ReplayClock
+	std::chrono::steady_clock::time_point lastSeen; // refreshed by audio client, see SETTING_MAX_TRANSMISSION
+	int frequency = 0; // kHz, 0 if unknown
+} draw_position;
+
+// Row flags
+constexpr uint8_t TX_FLAG_DRAWN = 1 << 0; // first OnRefresh that drew it has been recorded
+constexpr uint8_t TX_FLAG_HISTORY = 1 << 1; // ended, only in draw geometry snapshots
+constexpr uint8_t TX_FLAG_OVERLAP = 1 << 2; // overlapped another transmission on a shared frequency
+
+// Transmissions as structure of arrays, rows are unordered and removed by
+// swapping in the last row. Rows are keyed by interned callsign ID, a flat
+// index maps the ID to its row, so lookup is one load at any table size.
+class TransmissionTable
+{
+private:
+	std::vector<uint32_t> rowOf; // ID -> row + 1, 0 if absent, bounded by CallsignInterner::Capacity
+
+	auto Index(const uint32_t& key, const size_t& row) -> void {
+		if (key >= rowOf.size()) {
+			rowOf.resize(key + 1);
+		}
+		rowOf[key] = (uint32_t)row + 1;
+	}
+
+public:
+	// hot columns, read by drawing passes, resolved per screen from sample (see draw_geometry)
+	std::vector<double> latitude;
+	std::vector<double> longitude;
+	std::vector<double> radius;
+	std::vector<uint8_t> flags;
+	// key
+	std::vector<uint32_t> id; // interned callsign, see CallsignInterner
+	std::vector<inline_callsign> callsign;
+	// cold columns
+	std::vector<int> frequency; // kHz
+	std::vector<position_sample> sample;
+	std::vector<std::chrono::steady_clock::time_point> started;
+	std::vector<std::chrono::steady_clock::time_point> lastSeen;
+	std::vector<rx_trace> trace;
+	std::vector<int64_t> expiry; // tick of the live TimerWheel entry, 0 if none
+
+	auto Size(void) const -> size_t {
+		return id.size();
+	}
+	auto Empty(void) const -> bool {
+		return id.empty();
+	}
+
+	auto Find(const uint32_t& key) const -> std::optional<size_t> {
+		if (key >= rowOf.size() || !rowOf[key]) return std::nullopt;
+		return rowOf[key] - 1;
+	}
+
+	// inserts or overwrites, returns row
+	auto Set(const uint32_t& key, const inline_callsign& cs, const draw_position& dp, const uint8_t& rowFlags = 0) -> size_t {
+		auto found = Find(key);
+		size_t row = found ? *found : Size();
+		if (!found) {
+			latitude.emplace_back();
+			longitude.emplace_back();
+			radius.emplace_back();
+			flags.emplace_back();
+			id.push_back(key);
+			callsign.emplace_back();
+			frequency.emplace_back();
+			sample.emplace_back();
+			started.emplace_back();
+			lastSeen.emplace_back();
+			trace.emplace_back();
+			expiry.emplace_back();
+			Index(key, row);
+		}
+		latitude[row] = dp.sample.latitude;
+		longitude[row] = dp.sample.longitude;
+		radius[row] = 0;
+		flags[row] = rowFlags;
+		callsign[row] = cs;
+		frequency[row] = dp.frequency;
+		sample[row] = dp.sample;
+		started[row] = dp.started;
+		lastSeen[row] = dp.lastSeen;
+		trace[row] = dp.trace;
+		return row;
+	}
+
+	// appends a copy of a row of another table, returns row
+	auto Append(const TransmissionTable& other, const size_t& row) -> size_t {
+		latitude.push_back(other.latitude[row]);
+		longitude.push_back(other.longitude[row]);
+		radius.push_back(other.radius[row]);
+		flags.push_back(other.flags[row]);
+		id.push_back(other.id[row]);
+		callsign.push_back(other.callsign[row]);
+		frequency.push_back(other.frequency[row]);
+		sample.push_back(other.sample[row]);
+		started.push_back(other.started[row]);
+		lastSeen.push_back(other.lastSeen[row]);
+		trace.push_back(other.trace[row]);
+		expiry.push_back(other.expiry[row]);
+		Index(id.back(), Size() - 1);
+		return Size() - 1;
+	}
+
+	// swap-remove, the last row moves into row
+	auto Remove(const size_t& row) -> void {
+		size_t last = Size() - 1;
+		rowOf[id[row]] = 0;
+		if (row != last) {
+			latitude[row] = latitude[last];
+			longitude[row] = longitude[last];
+			radius[row] = radius[last];
+			flags[row] = flags[last];
+			id[row] = id[last];
+			callsign[row] = callsign[last];
+			frequency[row] = frequency[last];
+			sample[row] = sample[last];
+			started[row] = started[last];
+			lastSeen[row] = lastSeen[last];
+			trace[row] = trace[last];
+			expiry[row] = expiry[last];
+			rowOf[id[row]] = (uint32_t)row + 1;
+		}
+		latitude.pop_back();
+		longitude.pop_back();
+		radius.pop_back();
+		flags.pop_back();
+		id.pop_back();
+		callsign.pop_back();
+		frequency.pop_back();
+		sample.pop_back();
+		started.pop_back();
+		lastSeen.pop_back();
+		trace.pop_back();
+		expiry.pop_back();
+	}
+
+	auto Clear(void) -> void {
+		for (const auto& key : id) {
+			rowOf[key] = 0;
+		}
+		latitude.clear();
+		longitude.clear();
+		radius.clear();
+		flags.clear();
+		id.clear();
+		callsign.clear();
+		frequency.clear();
+		sample.clear();
+		started.clear();
+		lastSeen.clear();
+		trace.clear();
+		expiry.clear();
+	}
+};
+
+// Active receptions, one entry per (callsign ID, frequency) pair
+// A callsign stays in the transmission table while it has any reception. Only a
+// handful of frequencies are active at a time, so buckets are a flat vector and
+// empty ones are dropped.
+class FrequencyIndex
+{
+	// not thread safe, guarded by mtxTransmission
+private:
+	std::vector<int> frequencies; // kHz, 0 if unknown
+	std::vector<std::vector<uint32_t>> buckets; // callsign IDs, parallel to frequencies
+
+	auto Bucket(const int& frequency) const -> std::optional<size_t> {
+		for (size_t i = 0; i < frequencies.size(); i++) {
+			if (frequencies[i] == frequency) return i;
+		}
+		return std::nullopt;
+	}
+	auto Erase(const size_t& bucket, const size_t& i) -> void {
+		auto& cs = buckets[bucket];
+		cs[i] = cs.back();
+		cs.pop_back();
+		if (cs.empty()) {
+			if (bucket != buckets.size() - 1) {
+				frequencies[bucket] = frequencies.back();
+				buckets[bucket] = std::move(buckets.back());
+			}
+			frequencies.pop_back();
+			buckets.pop_back();
+		}
+	}
+
+public:
+	// returns true if the pair is new
+	auto Add(const uint32_t& callsign, const int& frequency) -> bool {
+		auto bucket = Bucket(frequency);
+		if (!bucket) {
+			frequencies.push_back(frequency);
+			buckets.emplace_back();
+			bucket = buckets.size() - 1;
+		}
+		auto& cs = buckets[*bucket];
+		if (std::find(cs.begin(), cs.end(), callsign) != cs.end()) return false;
+		cs.push_back(callsign);
+		return true;
+	}
+
+	// returns true if the pair existed
+	auto Remove(const uint32_t& callsign, const int& frequency) -> bool {
+		auto bucket = Bucket(frequency);
+		if (!bucket) return false;
+		auto& cs = buckets[*bucket];
+		auto it = std::find(cs.begin(), cs.end(), callsign);
+		if (it == cs.end()) return false;
+		Erase(*bucket, it - cs.begin());
+		return true;
+	}
+
+	auto RemoveAll(const uint32_t& callsign) -> void {
+		for (size_t b = frequencies.size(); b-- > 0;) { // backwards, Erase may move the last bucket
+			auto& cs = buckets[b];
+			auto it = std::find(cs.begin(), cs.end(), callsign);
+			if (it != cs.end()) {
+				Erase(b, it - cs.begin());
+			}
+		}
+	}
+
+	// number of frequencies the callsign is received on
+	auto Count(const uint32_t& callsign) const -> size_t {
+		size_t count = 0;
+		for (const auto& cs : buckets) {
+			count += std::count(cs.begin(), cs.end(), callsign);
+		}
+		return count;
+	}
+
+	// func(callsign ID) for every pair whose frequency passes filter(frequency), a callsign may repeat
+	auto ForEach(const auto& filter, const auto& func) const -> void {
+		for (size_t b = 0; b < frequencies.size(); b++) {
+			if (!filter(frequencies[b])) continue;
+			for (const auto& cs : buckets[b]) {
+				func(cs);
+			}
+		}
+	}
+
+	auto Clear(void) -> void {
+		frequencies.clear();
+		buckets.clear();
+	}
+};
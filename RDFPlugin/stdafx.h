@@ -16,19 +16,28 @@
 #include <string>
 #include <regex>
 #include <sstream>
+#include <string_view>
+#include <charconv>
 // thread
 #include <mutex>
 #include <shared_mutex>
 #include <atomic>
+#include <thread>
+#include <future>
+#include <condition_variable>
+#include <chrono>
 // container
 #include <vector>
+#include <array>
 #include <set>
 #include <queue>
+#include <deque>
 #include <map>
 // others
 #include <random>
 #include <stdexcept>
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <optional>
 // networking
@@ -36,10 +45,14 @@
 #include <ixwebsocket/IXNetSystem.h>
 #include <ixwebsocket/IXWebSocket.h>
 #include <ixwebsocket/IXUserAgent.h>
+#include <ixwebsocket/IXSocket.h>
+#include <ixwebsocket/IXSocketConnect.h>
+#include <ixwebsocket/IXCancellationRequest.h>
 #pragma comment(lib, "Crypt32.lib")
 #pragma comment(lib, "wsock32.lib")
 #pragma comment(lib, "shlwapi.lib")
 #pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "Msimg32.lib") // TransparentBlt
 // external
 #include <nlohmann/json.hpp>
 #include <EuroScopePlugIn.h>
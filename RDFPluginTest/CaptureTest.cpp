@@ -0,0 +1,139 @@
+// CaptureTest.cpp : capture file round trip, suppression while replaying and the replay clock
+
+#include <gtest/gtest.h>
+
+#include "RDFCapture.h"
+
+namespace {
+
+	constexpr auto CAPTURE_TEST_FILE = "RDFCaptureTest.bin";
+	constexpr uint64_t CAPTURE_TEST_SPAN_US = 3600ULL * 1000 * 1000; // an hour of traffic
+
+	auto Write(const std::filesystem::path& path, const std::function<void(CaptureWriter&)>& func) -> void {
+		CaptureWriter writer;
+		ASSERT_TRUE(writer.Start(path));
+		func(writer);
+		writer.Stop();
+	}
+
+	auto ReadAll(const std::filesystem::path& path) -> std::vector<capture_record> {
+		CaptureReader reader;
+		EXPECT_TRUE(reader.Open(path));
+		std::vector<capture_record> records;
+		capture_record record;
+		while (reader.Next(record)) {
+			records.push_back(record);
+		}
+		return records;
+	}
+
+}
+
+TEST(Capture, SuppressedRecordsAreNotWritten)
+{
+	auto path = std::filesystem::temp_directory_path() / CAPTURE_TEST_FILE;
+	Write(path, [](CaptureWriter& writer) {
+		writer.Record(CAPTURE_SOURCE_WS, "live1");
+		writer.Suppress(true); // replay running
+		writer.Record(CAPTURE_SOURCE_RDF, "replayed");
+		writer.Suppress(false);
+		writer.Record(CAPTURE_SOURCE_AFV, "live2");
+		});
+	auto records = ReadAll(path);
+	ASSERT_EQ(records.size(), 2u);
+	EXPECT_EQ(records[0].source, CAPTURE_SOURCE_WS);
+	EXPECT_EQ(records[0].payload, "live1");
+	EXPECT_EQ(records[1].source, CAPTURE_SOURCE_AFV);
+	EXPECT_EQ(records[1].payload, "live2");
+	EXPECT_LE(records[0].time, records[1].time);
+
+	// Span rewinds, records still follow
+	CaptureReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	EXPECT_EQ(reader.Span(), records[1].time - records[0].time);
+	capture_record record;
+	ASSERT_TRUE(reader.Next(record));
+	EXPECT_EQ(record.payload, "live1");
+	std::filesystem::remove(path);
+}
+
+TEST(Capture, RestartStartsFromEmptyBuffer)
+{
+	auto first = std::filesystem::temp_directory_path() / CAPTURE_TEST_FILE;
+	auto second = std::filesystem::temp_directory_path() / (std::string("2") + CAPTURE_TEST_FILE);
+	CaptureWriter writer;
+	ASSERT_TRUE(writer.Start(first));
+	writer.Record(CAPTURE_SOURCE_WS, "old");
+	writer.Stop();
+	writer.Record(CAPTURE_SOURCE_WS, "after stop"); // dropped, not carried into the next file
+	ASSERT_TRUE(writer.Start(second));
+	writer.Record(CAPTURE_SOURCE_AFV, "new");
+	writer.Stop();
+	auto records = ReadAll(second);
+	ASSERT_EQ(records.size(), 1u);
+	EXPECT_EQ(records[0].payload, "new");
+	EXPECT_EQ(ReadAll(first).size(), 1u);
+	std::filesystem::remove(first);
+	std::filesystem::remove(second);
+}
+
+TEST(Capture, CorruptSizesAreRejected)
+{
+	auto path = std::filesystem::temp_directory_path() / CAPTURE_TEST_FILE;
+	auto WriteRecord = [&](const uint32_t& size, const std::string& payload) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		uint64_t time = 0;
+		capture_source source = CAPTURE_SOURCE_WS;
+		file.write(CAPTURE_MAGIC, CAPTURE_MAGIC_SIZE);
+		file.write(reinterpret_cast<const char*>(&time), sizeof(time));
+		file.write(reinterpret_cast<const char*>(&source), sizeof(source));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(payload.data(), payload.size());
+	};
+	WriteRecord(5, "valid");
+	EXPECT_EQ(ReadAll(path).size(), 1u);
+	WriteRecord(0xFFFFFFF0, "huge"); // would allocate 4 GB
+	EXPECT_TRUE(ReadAll(path).empty());
+	WriteRecord(100, "truncated"); // below the cap, past the end of the file
+	EXPECT_TRUE(ReadAll(path).empty());
+	std::filesystem::remove(path);
+}
+
+TEST(ReplayClock, StepsThroughCaptureTimes)
+{
+	ReplayClock clock;
+	EXPECT_FALSE(clock.Replaying());
+	auto wall = std::chrono::steady_clock::now();
+	EXPECT_GE(clock.Now(), wall);
+
+	auto base = ReplayClock::Base(wall, CAPTURE_TEST_SPAN_US, 0.0); // MAX
+	clock.Begin(base);
+	EXPECT_TRUE(clock.Replaying());
+	EXPECT_EQ(clock.Now(), base);
+	clock.Set(base + std::chrono::seconds(90));
+	EXPECT_EQ(clock.Now(), base + std::chrono::seconds(90)); // stands still between records
+	EXPECT_EQ(clock.Now(), base + std::chrono::seconds(90));
+	clock.Set(base + std::chrono::seconds(30)); // never backwards
+	EXPECT_EQ(clock.Now(), base + std::chrono::seconds(90));
+	clock.End();
+	EXPECT_GE(clock.Now(), wall);
+}
+
+TEST(ReplayClock, NeverRunsAheadOfSteadyClock)
+{
+	auto wall = std::chrono::steady_clock::now();
+	auto span = std::chrono::microseconds(CAPTURE_TEST_SPAN_US);
+	for (const double speed : { 0.0, 0.5, 1.0, 2.0, 60.0 }) {
+		auto base = ReplayClock::Base(wall, CAPTURE_TEST_SPAN_US, speed);
+		// record at capture offset t is delivered at wall + t / speed, or at once for MAX
+		for (const double f : { 0.0, 0.25, 0.5, 1.0 }) {
+			auto offset = std::chrono::duration_cast<std::chrono::microseconds>(span * f);
+			auto delivered = speed > 0 ? wall + std::chrono::duration_cast<std::chrono::microseconds>(offset / speed) : wall;
+			EXPECT_LE(base + offset, delivered) << speed << " " << f;
+		}
+		if (speed == 0.0 || speed >= 1.0) { // live time continues where the replay ends
+			auto end = speed > 0 ? wall + std::chrono::duration_cast<std::chrono::microseconds>(span / speed) : wall;
+			EXPECT_LE(std::chrono::abs(end - (base + span)), std::chrono::milliseconds(1)) << speed;
+		}
+	}
+}
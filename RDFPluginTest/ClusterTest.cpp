@@ -0,0 +1,59 @@
+// ClusterTest.cpp : merging of overlapping RDF circles and bounded work when circles crowd one grid cell
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+
+#include "RDFCluster.h"
+
+namespace {
+
+	constexpr int CLUSTER_TEST_CIRCLES = 20000; // distinct circles sharing one grid cell
+	constexpr int CLUSTER_TEST_FRAMES = 10;
+
+	auto Circle(const double& x, const double& y, const double& r, const size_t& row) -> screen_circle {
+		return { x, y, r, row };
+	}
+
+}
+
+TEST(CircleClusterer, MergesOverlappingCircles)
+{
+	CircleClusterer clusterer;
+	std::vector<screen_circle> circles = {
+		Circle(100, 100, 10, 0),
+		Circle(102, 100, 10, 1), // 90% overlap with the seed
+		Circle(300, 100, 10, 2),
+	};
+	std::vector<uint8_t> flags = { 0, 4, 1 };
+	auto clusters = clusterer.Build(circles, flags, CLUSTER_OVERLAP_DEFAULT);
+	ASSERT_EQ(clusters.size(), 2u);
+	EXPECT_EQ(clusters[0].count, 2u);
+	EXPECT_EQ(clusters[0].first, 0u);
+	EXPECT_EQ(clusters[0].flags, 4);
+	EXPECT_GE(clusters[0].r, 11.0);
+	EXPECT_EQ(clusters[1].count, 1u);
+	EXPECT_EQ(clusters[1].first, 2u);
+}
+
+TEST(CircleClusterer, CrowdedCellTime)
+{
+	// one large circle sets the cell size, small ones that never merge all land in its cell
+	std::vector<screen_circle> circles;
+	circles.push_back(Circle(1.5 * CLUSTER_TEST_CIRCLES, 1.5 * CLUSTER_TEST_CIRCLES, CLUSTER_TEST_CIRCLES, 0));
+	for (int i = 0; i < CLUSTER_TEST_CIRCLES; i++) {
+		circles.push_back(Circle(i, 0, 0.1, circles.size()));
+	}
+	circles.push_back(Circle(CLUSTER_TEST_CIRCLES - 1, 0, 0.1, circles.size())); // matches the newest seed
+	std::vector<uint8_t> flags(circles.size());
+	CircleClusterer clusterer;
+	size_t count = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int f = 0; f < CLUSTER_TEST_FRAMES; f++) {
+		count = clusterer.Build(circles, flags, CLUSTER_OVERLAP_DEFAULT).size();
+	}
+	double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	EXPECT_EQ(count, (size_t)CLUSTER_TEST_CIRCLES + 1);
+	RecordProperty("ns_per_circle", std::to_string(us * 1000.0 / ((double)CLUSTER_TEST_FRAMES * circles.size())));
+	std::cout << circles.size() << " circles in one cell: " << us / CLUSTER_TEST_FRAMES << " us per frame" << std::endl;
+}
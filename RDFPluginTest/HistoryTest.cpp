@@ -0,0 +1,103 @@
+// HistoryTest.cpp : callsign ID reuse and the bounded transmission history
+
+#include <gtest/gtest.h>
+#include <deque>
+
+#include "RDFHistory.h"
+
+namespace {
+
+	constexpr int HISTORY_TEST_CALLSIGNS = 100000; // distinct callsigns over a long session
+
+	auto Entry(const std::string& callsign, const std::chrono::steady_clock::time_point& end) -> history_entry {
+		history_entry entry;
+		entry.callsign = inline_callsign(callsign);
+		entry.start = end - std::chrono::seconds(1);
+		entry.end = end;
+		return entry;
+	}
+
+}
+
+TEST(CallsignInterner, IdsAreFreedWithTheLastReference)
+{
+	CallsignInterner ids;
+	auto a = ids.Acquire("DLH1");
+	EXPECT_EQ(ids.Acquire("DLH1"), a);
+	auto b = ids.Acquire("BAW2");
+	EXPECT_NE(a, b);
+	EXPECT_EQ(ids.Size(), 2u);
+
+	ids.Release(a);
+	EXPECT_EQ(ids.Find("DLH1"), a); // one holder left
+	ids.Release(a);
+	EXPECT_FALSE(ids.Find("DLH1"));
+	EXPECT_EQ(ids.Size(), 1u);
+	ids.Release(a); // already free, ignored
+	EXPECT_EQ(ids.Size(), 1u);
+
+	auto c = ids.Acquire("AFR3"); // reuses the freed ID
+	EXPECT_EQ(c, a);
+	EXPECT_EQ(ids.Name(c), inline_callsign("AFR3"));
+	EXPECT_EQ(ids.Find("BAW2"), b);
+	EXPECT_EQ(ids.Capacity(), 2u);
+}
+
+TEST(CallsignInterner, CapacityFollowsLiveCallsigns)
+{
+	CallsignInterner ids;
+	std::deque<uint32_t> held;
+	for (int i = 0; i < HISTORY_TEST_CALLSIGNS; i++) {
+		held.push_back(ids.Acquire(inline_callsign("CS" + std::to_string(i))));
+		if (held.size() > 10) {
+			ids.Release(held.front());
+			held.pop_front();
+		}
+	}
+	EXPECT_EQ(ids.Size(), 10u);
+	EXPECT_LE(ids.Capacity(), 11u);
+}
+
+TEST(TransmissionHistory, RingHoldsIdsOfItsEntriesOnly)
+{
+	CallsignInterner ids;
+	TransmissionHistory history(ids);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < HISTORY_TEST_CALLSIGNS; i++) {
+		history.Push(Entry("CS" + std::to_string(i), start + std::chrono::milliseconds(i)));
+	}
+	EXPECT_EQ(history.Callsigns(), HISTORY_CAPACITY);
+	EXPECT_EQ(ids.Size(), HISTORY_CAPACITY);
+	EXPECT_LE(ids.Capacity(), HISTORY_CAPACITY + 1);
+
+	// oldest entries are gone, newest are found with their end
+	EXPECT_FALSE(history.LastEnd("CS0"));
+	auto last = history.LastEnd(inline_callsign("CS" + std::to_string(HISTORY_TEST_CALLSIGNS - 1)));
+	ASSERT_TRUE(last);
+	EXPECT_EQ(*last, start + std::chrono::milliseconds(HISTORY_TEST_CALLSIGNS - 1));
+
+	history.Clear();
+	EXPECT_EQ(ids.Size(), 0u);
+	EXPECT_FALSE(history.LastEnd(inline_callsign("CS" + std::to_string(HISTORY_TEST_CALLSIGNS - 1))));
+}
+
+TEST(TransmissionHistory, ReusedIdDoesNotInheritLastEnd)
+{
+	CallsignInterner ids;
+	TransmissionHistory history(ids);
+	auto start = std::chrono::steady_clock::now();
+	history.Push(Entry("OLD1", start));
+	for (size_t i = 0; i < HISTORY_CAPACITY; i++) { // pushes OLD1 out
+		history.Push(Entry("FILL", start + std::chrono::seconds(1 + i)));
+	}
+	EXPECT_FALSE(history.LastEnd("OLD1"));
+	EXPECT_EQ(history.Callsigns(), 1u);
+	history.Push(Entry("NEW2", start + std::chrono::hours(1))); // takes the ID of OLD1
+	EXPECT_EQ(*history.LastEnd("NEW2"), start + std::chrono::hours(1));
+	EXPECT_FALSE(history.LastEnd("OLD1"));
+
+	// ForEachSince is newest first and stops at since
+	std::vector<std::string> seen;
+	history.ForEachSince(start + std::chrono::seconds(HISTORY_CAPACITY), [&](const history_entry& entry) { seen.push_back(entry.callsign.String()); });
+	EXPECT_EQ(seen, (std::vector<std::string>{ "NEW2", "FILL" }));
+}
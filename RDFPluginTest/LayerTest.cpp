@@ -0,0 +1,125 @@
+// LayerTest.cpp : overlay layer re-rendered only when its key changes, drawn into a recording surface
+
+#include <gtest/gtest.h>
+
+#include "RDFLayer.h"
+
+namespace {
+
+	constexpr int LAYER_TEST_FRAMES = 100; // OnRefresh calls per view
+
+	// records what would be drawn, stands in for GdiLayerRasterizer
+	class RecordingRasterizer : public LayerRasterizer
+	{
+	public:
+		int renders = 0;
+		bool open = false;
+		layer_color pens[2] = {};
+		layer_color pen = 0;
+		std::vector<std::string> ops;
+
+		auto Begin(const int& width, const int& height, const layer_color& rgb, const layer_color& concurRGB) -> void override {
+			EXPECT_FALSE(open);
+			open = true;
+			renders++;
+			ops.clear();
+			pens[0] = rgb;
+			pens[1] = concurRGB;
+			SelectPen(false);
+			ops.push_back("begin " + std::to_string(width) + "x" + std::to_string(height));
+		}
+		auto SelectPen(const bool& concurrent) -> void override {
+			pen = pens[concurrent];
+		}
+		auto Polygon(const layer_point* points, const int& count) -> void override {
+			ops.push_back("polygon " + std::to_string(count) + " " + std::to_string(pen));
+		}
+		auto Ellipse(const int& left, const int& top, const int& right, const int& bottom) -> void override {
+			ops.push_back("ellipse " + std::to_string(right - left) + " " + std::to_string(pen));
+		}
+		auto Line(const layer_point& from, const layer_point& to) -> void override {
+			ops.push_back("line " + std::to_string(pen));
+		}
+		auto Text(const layer_point& anchor, const std::string_view& text) -> void override {
+			ops.push_back("text " + std::string(text) + " " + std::to_string(pen));
+		}
+		auto End(void) -> void override {
+			EXPECT_TRUE(open);
+			open = false;
+		}
+	};
+
+	typedef struct _layer_view {
+		uint64_t build = 1; // geometry
+		layer_color rgb = 0x000000FF;
+		layer_color concurRGB = 0x0000FF00;
+		int width = 800;
+		int height = 600;
+		double latitude = 50.0; // display area
+		int lod = 0;
+	} layer_view;
+
+	// mirrors the layer part of CRDFScreen::OnRefresh
+	auto Refresh(LayerRasterizer& raster, LayerCache& cache, const layer_view& view) -> void {
+		LayerKey key;
+		key.Add(view.build);
+		key.Add(view.rgb);
+		key.Add(view.concurRGB);
+		key.Add(view.width);
+		key.Add(view.height);
+		key.Add(view.latitude);
+		key.Add(view.lod);
+		if (cache.Hit(key.Value())) return;
+		raster.Begin(view.width, view.height, view.rgb, view.concurRGB);
+		raster.Line({ view.width / 2, view.height / 2 }, { 10, 10 });
+		raster.SelectPen(true);
+		raster.Ellipse(90, 90, 110, 110);
+		raster.Text({ 100, 104 }, "2");
+		raster.End();
+	}
+
+}
+
+TEST(Layer, RendersOnlyWhenKeyChanges)
+{
+	RecordingRasterizer raster;
+	LayerCache cache;
+	layer_view view;
+	for (int i = 0; i < LAYER_TEST_FRAMES; i++) {
+		Refresh(raster, cache, view);
+	}
+	EXPECT_EQ(raster.renders, 1);
+	EXPECT_EQ(raster.ops, (std::vector<std::string>{ "begin 800x600", "line 255", "ellipse 20 65280", "text 2 65280" }));
+
+	// every input of the key re-renders once
+	std::vector<std::function<void(layer_view&)>> changes = {
+		[](layer_view& v) { v.build++; },
+		[](layer_view& v) { v.rgb = 0x00FFFFFF; },
+		[](layer_view& v) { v.concurRGB = 0x00FFFFFF; },
+		[](layer_view& v) { v.width = 1024; },
+		[](layer_view& v) { v.latitude += 0.001; }, // pan
+		[](layer_view& v) { v.lod++; },
+	};
+	int expected = 1;
+	for (const auto& change : changes) {
+		change(view);
+		for (int i = 0; i < LAYER_TEST_FRAMES; i++) {
+			Refresh(raster, cache, view);
+		}
+		EXPECT_EQ(raster.renders, ++expected);
+	}
+
+	// settings reload or geometry gone
+	cache.Invalidate();
+	Refresh(raster, cache, view);
+	EXPECT_EQ(raster.renders, ++expected);
+	EXPECT_EQ(cache.Summary(), std::to_string(LAYER_TEST_FRAMES * 7 - 7) + " hits, " + std::to_string(expected) + " renders");
+}
+
+TEST(Layer, ColorKeyIsNeverAPenColor)
+{
+	EXPECT_EQ(LayerColorKey(0x000000FF, 0x0000FF00), LAYER_COLOR_KEY);
+	EXPECT_EQ(LayerColorKey(LAYER_COLOR_KEY, 0x0000FF00), LAYER_COLOR_KEY_ALT);
+	EXPECT_EQ(LayerColorKey(0x000000FF, LAYER_COLOR_KEY), LAYER_COLOR_KEY_ALT);
+	EXPECT_NE(LAYER_COLOR_KEY, LAYER_COLOR_KEY_ALT);
+}
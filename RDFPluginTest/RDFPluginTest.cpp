@@ -0,0 +1,9 @@
+// RDFPluginTest.cpp : off-line tests of the plugin modules, no EuroScope or audio client needed
+
+#include <gtest/gtest.h>
+
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+// ReconnectTest.cpp : TrackAudio backoff and the liveness probe state machine driven as CRDFPlugin drives it
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+
+#include "RDFReconnect.h"
+
+namespace {
+
+	constexpr auto RECONNECT_TEST_TIMEOUT_SEC = 5;
+
+	// records what ReconnectDriver does to the socket, stands in for ix::WebSocket
+	class FakeSocket
+	{
+	public:
+		uint32_t minWait = 0;
+		uint32_t maxWait = 0;
+		int stops = 0;
+		int starts = 0;
+
+		auto setMinWaitBetweenReconnectionRetries(const uint32_t& ms) -> void {
+			minWait = ms;
+		}
+		auto setMaxWaitBetweenReconnectionRetries(const uint32_t& ms) -> void {
+			maxWait = ms;
+		}
+		auto stop(void) -> void {
+			stops++;
+		}
+		auto start(void) -> void {
+			starts++;
+		}
+	};
+
+	// probe that blocks until released, then answers alive or not
+	class GatedProbe
+	{
+	public:
+		std::atomic_int calls = 0;
+		std::atomic_int running = 0;
+		std::atomic_int overlapped = 0;
+		std::atomic_bool open = false;
+		std::atomic_bool alive = false;
+
+		auto Probe(void) -> bool {
+			calls++;
+			if (running.fetch_add(1) > 0) {
+				overlapped++;
+			}
+			while (!open) {
+				std::this_thread::yield();
+			}
+			running--;
+			return alive;
+		}
+
+		auto Bind(void) -> std::function<bool(void)> {
+			return [this]() { return Probe(); };
+		}
+	};
+
+	// spins until pred holds, false on timeout
+	auto WaitFor(const std::function<bool(void)>& pred) -> bool {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(RECONNECT_TEST_TIMEOUT_SEC);
+		while (!pred()) {
+			if (std::chrono::steady_clock::now() > deadline) return false;
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+}
+
+TEST(ReconnectPolicy, DelayIsCappedWithEqualJitter)
+{
+	for (uint32_t retries = 0; retries < 40; retries++) {
+		uint32_t base = retries < 16 ? std::min((uint32_t)TRACKAUDIO_RECONNECT_MIN_MS << retries, (uint32_t)TRACKAUDIO_RECONNECT_MAX_MS) : TRACKAUDIO_RECONNECT_MAX_MS;
+		for (int i = 0; i < 100; i++) {
+			auto delay = ReconnectPolicy::Delay(retries);
+			ASSERT_GE(delay, base / 2) << retries;
+			ASSERT_LE(delay, base) << retries;
+		}
+	}
+}
+
+TEST(ReconnectPolicy, ProbesOneAtATimeWhileBackingOff)
+{
+	ReconnectPolicy reconnect;
+	EXPECT_FALSE(reconnect.BeginProbe()); // ixwebsocket retries soon enough
+	reconnect.Failed(16);
+	EXPECT_GT(reconnect.Wait(), (uint32_t)TRACKAUDIO_PROBE_MIN_WAIT_MS);
+	EXPECT_TRUE(reconnect.BeginProbe());
+	EXPECT_FALSE(reconnect.BeginProbe());
+	EXPECT_FALSE(reconnect.BeginProbe());
+	reconnect.EndProbe();
+	EXPECT_TRUE(reconnect.BeginProbe());
+	reconnect.EndProbe();
+	EXPECT_EQ(reconnect.Reset(), (uint32_t)TRACKAUDIO_RECONNECT_MIN_MS);
+	EXPECT_FALSE(reconnect.BeginProbe());
+}
+
+TEST(ReconnectDriver, BackoffIsAppliedToSocket)
+{
+	FakeSocket socket;
+	ReconnectDriver<FakeSocket> driver(socket);
+	driver.Reset();
+	EXPECT_EQ(socket.minWait, (uint32_t)TRACKAUDIO_RECONNECT_MIN_MS);
+	EXPECT_EQ(socket.maxWait, (uint32_t)TRACKAUDIO_RECONNECT_MIN_MS);
+	driver.Failed(16);
+	EXPECT_EQ(socket.minWait, driver.Wait());
+	EXPECT_EQ(socket.maxWait, driver.Wait());
+	EXPECT_GE(socket.minWait, (uint32_t)TRACKAUDIO_RECONNECT_MAX_MS / 2);
+	driver.Reset(); // connection open
+	EXPECT_EQ(socket.minWait, (uint32_t)TRACKAUDIO_RECONNECT_MIN_MS);
+}
+
+TEST(ReconnectDriver, ProbesOnlyWhileClosedAndBackingOff)
+{
+	FakeSocket socket;
+	GatedProbe probe;
+	probe.open = true;
+	ReconnectDriver<FakeSocket> driver(socket);
+	driver.Tick(true, probe.Bind()); // ixwebsocket retries soon enough
+	driver.Failed(16);
+	driver.Tick(false, probe.Bind()); // connected
+	driver.Join();
+	EXPECT_EQ(probe.calls, 0);
+	EXPECT_FALSE(driver.Probing());
+}
+
+TEST(ReconnectDriver, ProbesOneAtATime)
+{
+	FakeSocket socket;
+	GatedProbe probe;
+	ReconnectDriver<FakeSocket> driver(socket);
+	driver.Failed(16);
+	driver.Tick(true, probe.Bind());
+	ASSERT_TRUE(WaitFor([&]() { return probe.calls == 1; }));
+	for (int i = 0; i < 10; i++) { // timer ticks while the probe hangs
+		driver.Tick(true, probe.Bind());
+	}
+	EXPECT_EQ(probe.calls, 1);
+	EXPECT_TRUE(driver.Probing());
+
+	// endpoint still down: the probe ends itself and the next tick probes again
+	probe.open = true;
+	driver.Join();
+	EXPECT_FALSE(driver.Probing());
+	driver.Tick(true, probe.Bind());
+	driver.Join();
+	EXPECT_EQ(probe.calls, 2);
+	EXPECT_EQ(probe.overlapped, 0);
+	EXPECT_EQ(socket.starts, 0);
+}
+
+TEST(ReconnectDriver, RestartsWhenEndpointAnswers)
+{
+	FakeSocket socket;
+	GatedProbe probe;
+	probe.open = true;
+	probe.alive = true; // restart posted, the probe stays owned until Restart
+	ReconnectDriver<FakeSocket> driver(socket);
+	driver.Failed(16);
+	driver.Tick(true, probe.Bind());
+	driver.Join();
+	EXPECT_TRUE(driver.Probing());
+	driver.Tick(true, probe.Bind());
+	driver.Join();
+	EXPECT_EQ(probe.calls, 1);
+
+	EXPECT_TRUE(driver.Restart(true));
+	EXPECT_FALSE(driver.Probing());
+	EXPECT_EQ(socket.stops, 1);
+	EXPECT_EQ(socket.starts, 1);
+
+	// connected by the time the posted restart runs: nothing to do
+	driver.Tick(true, probe.Bind());
+	driver.Join();
+	EXPECT_FALSE(driver.Restart(false));
+	EXPECT_FALSE(driver.Probing());
+	EXPECT_EQ(socket.starts, 1);
+}
@@ -0,0 +1,121 @@
+// ScreenRegistryTest.cpp : radar screen slot reuse, stale handles and screens deleting themselves on close
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+
+#include "RDFScreenRegistry.h"
+
+namespace {
+
+	constexpr size_t SCREEN_TEST_PAYLOAD = 64 * 1024; // bytes held per screen, stands in for settings and ASR data
+	constexpr int SCREEN_TEST_CYCLES = 10000;
+
+	// counts live instances and the memory they hold
+	class FakeScreen
+	{
+	public:
+		static inline std::atomic_int64_t live = 0;
+		static inline std::atomic_int64_t bytes = 0;
+		screen_handle handle;
+		std::vector<char> payload;
+
+		FakeScreen(const screen_handle& handle) : handle(handle), payload(SCREEN_TEST_PAYLOAD) {
+			live++;
+			bytes += payload.capacity();
+		}
+
+		~FakeScreen(void) {
+			live--;
+			bytes -= payload.capacity();
+		}
+	};
+
+	auto Create(const screen_handle& handle) -> FakeScreen* {
+		return new FakeScreen(handle);
+	}
+
+	// OnAsrContentToBeClosed: unregister, then delete this
+	auto Close(ScreenRegistry<FakeScreen>& registry, FakeScreen* screen) -> bool {
+		bool closed = registry.Close(screen->handle);
+		delete screen;
+		return closed;
+	}
+
+}
+
+TEST(ScreenRegistry, OpenCloseCyclesReuseSlotsAndReleaseMemory)
+{
+	{
+		ScreenRegistry<FakeScreen> registry;
+		auto kept = registry.Open(Create); // stays open, like the main ASR
+		size_t maxSlots = 0;
+		int64_t maxLive = 0;
+		for (int i = 0; i < SCREEN_TEST_CYCLES; i++) {
+			auto screen = registry.Open(Create);
+			maxLive = std::max(maxLive, FakeScreen::live.load());
+			ASSERT_TRUE(Close(registry, screen));
+			maxSlots = std::max(maxSlots, registry.Slots());
+		}
+		// kept screen plus the one being cycled, independent of the number of cycles
+		EXPECT_EQ(maxSlots, 2u);
+		EXPECT_EQ(maxLive, 2);
+		EXPECT_EQ(FakeScreen::live, 1);
+		EXPECT_EQ(FakeScreen::bytes, (int64_t)kept->payload.capacity());
+		EXPECT_EQ(registry.Get(kept->handle), kept);
+		EXPECT_TRUE(Close(registry, kept));
+	}
+	EXPECT_EQ(FakeScreen::live, 0);
+	EXPECT_EQ(FakeScreen::bytes, 0);
+}
+
+TEST(ScreenRegistry, StaleHandlesResolveToNothing)
+{
+	ScreenRegistry<FakeScreen> registry;
+	auto first = registry.Open(Create)->handle;
+	ASSERT_TRUE(Close(registry, registry.Get(first)));
+	EXPECT_EQ(registry.Get(first), nullptr);
+	EXPECT_FALSE(registry.Close(first));
+
+	// same slot, next generation
+	auto second = registry.Open(Create)->handle;
+	EXPECT_EQ(second.id, first.id);
+	EXPECT_NE(second.generation, first.generation);
+	EXPECT_EQ(registry.Get(first), nullptr);
+	EXPECT_NE(registry.Get(second), nullptr);
+	EXPECT_FALSE(registry.Close(first));
+	EXPECT_NE(registry.Get(second), nullptr);
+
+	EXPECT_EQ(registry.Get(screen_handle{}), nullptr); // plugin settings
+	EXPECT_EQ(registry.Get(screen_handle{ 100, 0 }), nullptr);
+	Close(registry, registry.Get(second));
+}
+
+TEST(ScreenRegistry, ClosedScreenIsForgottenAtOnce)
+{
+	// the screen is deleted right after Close, nothing may reach it afterwards
+	ScreenRegistry<FakeScreen> registry;
+	auto screen = registry.Open(Create);
+	auto handle = screen->handle;
+	ASSERT_TRUE(Close(registry, screen));
+	EXPECT_EQ(FakeScreen::live, 0);
+	EXPECT_EQ(registry.Get(handle), nullptr);
+	int visited = 0;
+	registry.ForEach([&](FakeScreen&) { visited++; });
+	EXPECT_EQ(visited, 0);
+	EXPECT_EQ(registry.Summary(), "0 open, 1 slots, 1 opened, 1 closed");
+}
+
+TEST(ScreenRegistry, ForEachVisitsOpenScreens)
+{
+	ScreenRegistry<FakeScreen> registry;
+	auto a = registry.Open(Create);
+	auto b = registry.Open(Create);
+	auto c = registry.Open(Create);
+	Close(registry, b);
+	std::vector<int> visited;
+	registry.ForEach([&](FakeScreen& s) { visited.push_back(s.handle.id); });
+	EXPECT_EQ(visited, (std::vector<int>{ a->handle.id, c->handle.id }));
+	Close(registry, a);
+	Close(registry, c);
+}
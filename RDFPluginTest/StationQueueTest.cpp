@@ -0,0 +1,202 @@
+// StationQueueTest.cpp : kStationStateUpdate coalescing, driven with a synthetic clock
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "RDFStationQueue.h"
+
+namespace {
+
+	using namespace std::chrono_literals;
+
+	// stands in for CRDFPlugin::HiddenWndApplyStationStates, pops at the time the timer would fire
+	class StationApplier
+	{
+	public:
+		StationUpdateQueue queue;
+		std::map<std::pair<std::string, int>, int> applies; // callsign and frequency
+		std::map<std::pair<std::string, int>, station_state> channels;
+		std::vector<std::vector<int>> reconciles;
+		std::optional<std::chrono::steady_clock::time_point> timer;
+
+		auto Push(const std::string& callsign, const station_state& state, const std::chrono::steady_clock::time_point& now) -> station_push {
+			auto push = queue.Push(inline_callsign(callsign), state, now);
+			if (push == STATION_PUSH_FIRST) {
+				Apply(now); // WM_RDF_STATIONS
+			}
+			return push;
+		}
+
+		auto Reconcile(const std::vector<int>& active, const std::chrono::steady_clock::time_point& now) -> station_push {
+			auto push = queue.Reconcile(active, now);
+			if (push == STATION_PUSH_FIRST) {
+				Apply(now);
+			}
+			return push;
+		}
+
+		auto Apply(const std::chrono::steady_clock::time_point& now) -> void {
+			timer.reset();
+			station_batch due;
+			auto next = queue.Pop(now, due);
+			if (next) {
+				timer = now + *next;
+			}
+			for (const auto& update : due.updates) {
+				auto key = std::make_pair(std::string(update.callsign.chars.data()), update.state.frequency);
+				applies[key]++;
+				channels[key] = update.state;
+			}
+			if (due.reconcile) {
+				reconciles.push_back(*due.reconcile);
+				for (auto& [key, state] : channels) {
+					if (std::none_of(due.reconcile->begin(), due.reconcile->end(), [&](const int& f) { return abs(f - key.second) <= STATION_SYNC_TOLERANCE_KHZ; })) {
+						state.rx = state.tx = false;
+					}
+				}
+			}
+		}
+
+		// fires the timer until the queue is drained
+		auto Drain(void) -> void {
+			while (timer) {
+				Apply(*timer);
+			}
+		}
+	};
+
+	auto Station(const std::string& callsign, const int& frequency) -> std::pair<std::string, int> {
+		return { callsign, frequency };
+	}
+
+	const std::vector<std::pair<std::string, int>> STATIONS = {
+		{ "EDDF_TWR", 119905 }, { "EDDF_GND", 121805 }, { "EDDF_APP", 120805 }, { "EDDF_DEL", 121905 }, { "EDDF_ATIS", 118030 }
+	};
+
+}
+
+TEST(StationUpdateQueue, StormAppliesOncePerStation)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	// 200 updates within 20 ms, each station cycles RX, then TX, then XC
+	int pushes = 200, superseded = 0;
+	std::map<std::string, station_state> last;
+	for (int i = 0; i < pushes; i++) {
+		const auto& [callsign, frequency] = STATIONS[i % STATIONS.size()];
+		int step = (int)(i / STATIONS.size()) % 3;
+		station_state state{ frequency, true, step >= 1 };
+		last[callsign] = state;
+		if (applier.Push(callsign, state, start + std::chrono::microseconds(i * 100)) == STATION_PUSH_SUPERSEDED) {
+			superseded++;
+		}
+	}
+	EXPECT_TRUE(applier.applies.empty()); // nothing applied within the window
+	applier.Drain();
+	EXPECT_EQ(superseded, pushes - (int)STATIONS.size());
+	ASSERT_EQ(applier.applies.size(), STATIONS.size());
+	for (const auto& [callsign, frequency] : STATIONS) {
+		auto key = std::make_pair(callsign, frequency);
+		EXPECT_EQ(applier.applies[key], 1) << callsign;
+		EXPECT_EQ(applier.channels[key].rx, last[callsign].rx) << callsign;
+		EXPECT_EQ(applier.channels[key].tx, last[callsign].tx) << callsign;
+	}
+}
+
+TEST(StationUpdateQueue, SeparateBurstsApplySeparately)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	for (int burst = 0; burst < 3; burst++) {
+		auto at = start + burst * 200ms;
+		for (int i = 0; i < 10; i++) {
+			applier.Push("EDDF_TWR", { 119905, true, i % 2 == 0 }, at + std::chrono::milliseconds(i));
+		}
+		applier.Drain();
+		EXPECT_EQ(applier.applies[Station("EDDF_TWR", 119905)], burst + 1);
+	}
+	EXPECT_FALSE(applier.channels[Station("EDDF_TWR", 119905)].tx); // last of each burst is RX only
+}
+
+TEST(StationUpdateQueue, WindowStartsAtFirstUpdate)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	applier.Push("EDDF_TWR", { 119905, true, false }, start);
+	ASSERT_TRUE(applier.timer);
+	EXPECT_EQ(*applier.timer, start + std::chrono::milliseconds(STATION_UPDATE_WINDOW_MS));
+	// a later update does not extend the window
+	applier.Push("EDDF_TWR", { 119905, true, true }, start + 40ms);
+	applier.Apply(start + std::chrono::milliseconds(STATION_UPDATE_WINDOW_MS));
+	EXPECT_EQ((applier.applies[Station("EDDF_TWR", 119905)]), 1);
+	EXPECT_FALSE(applier.timer);
+}
+
+TEST(StationUpdateQueue, SameFrequencyDifferentCallsign)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(applier.Push("EDDF_TWR", { 119905, true, false }, start), STATION_PUSH_FIRST);
+	EXPECT_EQ(applier.Push("", { 119905, true, true }, start + 1ms), STATION_PUSH_HELD);
+	applier.Drain();
+	EXPECT_EQ(applier.applies.size(), 2u);
+}
+
+TEST(StationUpdateQueue, ReconcileAfterUpdates)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	// kStationStates: the updates of the message, then its reconcile
+	applier.Push("EDDF_TWR", { 119905, true, true }, start);
+	applier.Push("EDDF_GND", { 121805, true, false }, start);
+	EXPECT_EQ(applier.Reconcile({ 119905, 121805 }, start), STATION_PUSH_HELD);
+	applier.Drain();
+	ASSERT_EQ(applier.reconciles.size(), 1u);
+	EXPECT_EQ(applier.reconciles[0], (std::vector<int>{ 119905, 121805 }));
+	EXPECT_TRUE((applier.channels[Station("EDDF_TWR", 119905)].rx));
+	EXPECT_TRUE((applier.channels[Station("EDDF_GND", 121805)].rx));
+}
+
+TEST(StationUpdateQueue, ReconcileCoalesces)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(applier.Reconcile({ 119905 }, start), STATION_PUSH_FIRST);
+	EXPECT_EQ(applier.Reconcile({ 121805 }, start + 10ms), STATION_PUSH_SUPERSEDED);
+	applier.Drain();
+	ASSERT_EQ(applier.reconciles.size(), 1u);
+	EXPECT_EQ(applier.reconciles[0], std::vector<int>{ 121805 });
+}
+
+TEST(StationUpdateQueue, LaterUpdatesAdjustReconcile)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	applier.Reconcile({ 119905, 121805 }, start);
+	// GND closed and APP opened after the kStationStates, within its window
+	applier.Push("EDDF_GND", { 121800, false, false }, start + 5ms);
+	applier.Push("EDDF_APP", { 120805, true, false }, start + 10ms);
+	applier.Apply(start + std::chrono::milliseconds(STATION_UPDATE_WINDOW_MS));
+	ASSERT_EQ(applier.reconciles.size(), 1u);
+	EXPECT_EQ(applier.reconciles[0], (std::vector<int>{ 119905, 120805 }));
+	// the later updates are still held and applied after the reconcile
+	EXPECT_EQ(applier.applies.size(), 0u);
+	applier.Drain();
+	EXPECT_TRUE((applier.channels[Station("EDDF_APP", 120805)].rx));
+	EXPECT_FALSE((applier.channels[Station("EDDF_GND", 121800)].rx));
+}
+
+TEST(StationUpdateQueue, ClearDropsEverything)
+{
+	StationApplier applier;
+	auto start = std::chrono::steady_clock::now();
+	applier.Push("EDDF_TWR", { 119905, true, false }, start);
+	applier.Reconcile({ 119905 }, start);
+	applier.queue.Clear();
+	station_batch due;
+	EXPECT_FALSE(applier.queue.Pop(start + 1s, due));
+	EXPECT_TRUE(due.updates.empty());
+	EXPECT_FALSE(due.reconcile);
+	// next push after a clear schedules a Pop again
+	EXPECT_EQ(applier.queue.Push(inline_callsign("EDDF_TWR"), { 119905, true, false }, start), STATION_PUSH_FIRST);
+}
@@ -0,0 +1,178 @@
+// TagIndexTest.cpp : tag item index lookups, truncated callsigns and readers racing the writer
+
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "RDFTagIndex.h"
+
+namespace {
+
+	constexpr int TAG_TEST_CALLSIGNS = 100;
+	constexpr int TAG_TEST_LOOKUPS = 100000; // formerly .RDF LOADTEST TAGS
+	constexpr auto TAG_TEST_RACE_MS = 200;
+
+	auto Callsign(const int& i) -> std::string {
+		return "TAG" + std::to_string(i);
+	}
+
+	// all fields of a callsign derive from round, so a torn read is detectable
+	auto Build(const uint32_t& round, const std::chrono::steady_clock::time_point& base) -> TagIndex::build_list {
+		TagIndex::build_list states;
+		for (int i = 0; i < TAG_TEST_CALLSIGNS; i++) {
+			auto& state = states.emplace_back(inline_callsign(Callsign(i)), tag_state()).second;
+			state.count = round * TAG_TEST_CALLSIGNS + i;
+			state.transmitting = round & 1;
+			state.lastEnd = base + std::chrono::nanoseconds(state.count);
+		}
+		return states;
+	}
+
+}
+
+TEST(TagIndex, FindsPublishedStates)
+{
+	TagIndex index;
+	auto now = std::chrono::steady_clock::now();
+	TagIndex::build_list states;
+	states.emplace_back(inline_callsign("BAW45"), tag_state{ false, now, 3 });
+	states.emplace_back(inline_callsign("DLH123"), tag_state{ true, std::nullopt, 0 });
+	index.Publish(states, 1);
+
+	auto dlh = index.Find("DLH123");
+	ASSERT_TRUE(dlh);
+	EXPECT_TRUE(dlh->transmitting);
+	EXPECT_FALSE(dlh->lastEnd);
+	auto baw = index.Find("BAW45");
+	ASSERT_TRUE(baw);
+	EXPECT_FALSE(baw->transmitting);
+	EXPECT_EQ(baw->count, 3u);
+	EXPECT_EQ(*baw->lastEnd, std::chrono::time_point_cast<std::chrono::nanoseconds>(now));
+	EXPECT_FALSE(index.Find("AFR1"));
+	EXPECT_FALSE(index.Find(""));
+
+	// a rebuild drops what is no longer published
+	states.pop_back();
+	index.Publish(states, 2);
+	EXPECT_FALSE(index.Find("DLH123"));
+	EXPECT_TRUE(index.Find("BAW45"));
+}
+
+TEST(TagIndex, AggregatesSnapshotById)
+{
+	auto now = std::chrono::steady_clock::now();
+	tag_snapshot snapshot;
+	snapshot.windowStart = now - std::chrono::seconds(60);
+	snapshot.sources = {
+		{ inline_callsign("DLH123"), 4, std::nullopt }, // current
+		{ inline_callsign("DLH123"), 4, now - std::chrono::seconds(10) },
+		{ inline_callsign("BAW45"), 1, now - std::chrono::seconds(5) },
+		{ inline_callsign("DLH123"), 4, now - std::chrono::seconds(90) }, // out of the window
+		{ inline_callsign("BAW45"), 1, now - std::chrono::seconds(2) }, // order does not matter
+	};
+	auto states = TagIndex::Aggregate(snapshot);
+	ASSERT_EQ(states.size(), 2u);
+	EXPECT_EQ(states[0].first, inline_callsign("DLH123"));
+	EXPECT_TRUE(states[0].second.transmitting);
+	EXPECT_EQ(states[0].second.count, 1u);
+	EXPECT_EQ(*states[0].second.lastEnd, now - std::chrono::seconds(10));
+	EXPECT_EQ(states[1].first, inline_callsign("BAW45"));
+	EXPECT_FALSE(states[1].second.transmitting);
+	EXPECT_EQ(states[1].second.count, 2u);
+	EXPECT_EQ(*states[1].second.lastEnd, now - std::chrono::seconds(2));
+}
+
+TEST(TagIndex, OlderSnapshotIsDropped)
+{
+	// taken in order under the transmission lock, published in any order after it
+	TagIndex index;
+	TagIndex::build_list newer = { { inline_callsign("NEW1"), tag_state{ true, std::nullopt, 0 } } };
+	TagIndex::build_list older = { { inline_callsign("OLD1"), tag_state{ true, std::nullopt, 0 } } };
+	EXPECT_TRUE(index.Publish(newer, 6));
+	EXPECT_FALSE(index.Publish(older, 5));
+	EXPECT_TRUE(index.Find("NEW1"));
+	EXPECT_FALSE(index.Find("OLD1"));
+	EXPECT_EQ(index.Generation(), 1u);
+}
+
+TEST(TagIndex, TruncatedCallsignsDoNotCollide)
+{
+	// 15 characters are kept, the rest only survives in hash and length
+	const std::string prefix = "ABCDEFGHIJKLMNO";
+	const std::vector<std::string> callsigns = { prefix, prefix + "P", prefix + "Q", prefix + "PQ" };
+	for (size_t a = 0; a < callsigns.size(); a++) {
+		for (size_t b = 0; b < callsigns.size(); b++) {
+			EXPECT_EQ(inline_callsign(callsigns[a]) == inline_callsign(callsigns[b]), a == b) << callsigns[a] << " " << callsigns[b];
+		}
+	}
+	for (const auto& published : callsigns) {
+		TagIndex index;
+		TagIndex::build_list states = { { inline_callsign(published), tag_state{ true, std::nullopt, 1 } } };
+		index.Publish(states, 1);
+		for (const auto& looked : callsigns) {
+			EXPECT_EQ(index.Find(inline_callsign(looked)).has_value(), looked == published) << published << " " << looked;
+		}
+	}
+}
+
+TEST(TagIndex, ReadersNeverSeeTornStates)
+{
+	TagIndex index;
+	auto base = std::chrono::steady_clock::now();
+	index.Publish(Build(0, base), 0);
+	std::atomic_bool stop = false;
+	std::atomic_uint64_t lookups = 0, misses = 0, torn = 0;
+	auto Reader = [&]() {
+		for (int i = 0; !stop; i = (i + 1) % TAG_TEST_CALLSIGNS) {
+			auto state = index.Find(inline_callsign(Callsign(i)));
+			lookups++;
+			if (!state || !state->lastEnd) {
+				misses++;
+				continue;
+			}
+			uint32_t round = state->count / TAG_TEST_CALLSIGNS;
+			if (state->count % TAG_TEST_CALLSIGNS != (uint32_t)i || state->transmitting != (bool)(round & 1)
+				|| *state->lastEnd != base + std::chrono::nanoseconds(state->count)) {
+				torn++;
+			}
+		}
+		};
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 3; r++) {
+		readers.emplace_back(Reader);
+	}
+	// prebuilt, so the writer spends its time inside the seqlock
+	std::array<TagIndex::build_list, 2> builds = { Build(1, base), Build(2, base) };
+	auto finish = std::chrono::steady_clock::now() + std::chrono::milliseconds(TAG_TEST_RACE_MS);
+	uint64_t publishes = 0;
+	while (std::chrono::steady_clock::now() < finish) {
+		index.Publish(builds[publishes & 1], publishes);
+		publishes++;
+	}
+	stop = true;
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	EXPECT_GT(lookups, 0u);
+	EXPECT_EQ(misses, 0u); // every callsign is in every build
+	EXPECT_EQ(torn, 0u);
+	EXPECT_EQ(index.Generation(), publishes + 1);
+}
+
+TEST(TagIndex, LookupTime)
+{
+	TagIndex index;
+	index.Publish(Build(0, std::chrono::steady_clock::now()), 0);
+	std::vector<inline_callsign> callsigns;
+	for (int i = 0; i < TAG_TEST_CALLSIGNS * 2; i++) { // half of them miss
+		callsigns.emplace_back(Callsign(i));
+	}
+	size_t found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < TAG_TEST_LOOKUPS; i++) {
+		found += index.Find(callsigns[i % callsigns.size()]).has_value();
+	}
+	double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	EXPECT_EQ(found, (size_t)TAG_TEST_LOOKUPS / 2);
+	RecordProperty("ns_per_lookup", std::to_string(us * 1000.0 / TAG_TEST_LOOKUPS));
+	std::cout << TAG_TEST_LOOKUPS << " lookups in " << us << " us (" << us * 1000.0 / TAG_TEST_LOOKUPS << " ns each)" << std::endl;
+}
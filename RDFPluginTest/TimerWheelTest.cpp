@@ -0,0 +1,130 @@
+// TimerWheelTest.cpp : expiry wheel firing and one live entry per transmission row
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "RDFTimerWheel.h"
+#include "RDFTransmissionTable.h"
+
+namespace {
+
+	constexpr int64_t WHEEL_TEST_MAX_SEC = 60;
+	constexpr int WHEEL_TEST_TOUCHES = 10000; // keep-alives of one long transmission
+
+	// mirrors TouchTransmission and ExpireTransmissions of CRDFPlugin, with ticks for time
+	class ExpiryHarness
+	{
+	public:
+		TransmissionTable table;
+		TimerWheel<uint32_t> wheel;
+		std::vector<int64_t> lastSeen; // by row, ticks
+		std::vector<inline_callsign> expired;
+
+		auto Begin(const uint32_t& id, const std::string& callsign, const int64_t& now) -> void {
+			size_t row = table.Set(id, inline_callsign(callsign), draw_position());
+			lastSeen.resize(table.Size());
+			Touch(row, now);
+		}
+
+		auto Touch(const size_t& row, const int64_t& now) -> void {
+			lastSeen[row] = now;
+			if (!table.expiry[row]) {
+				table.expiry[row] = wheel.Schedule(table.id[row], now + WHEEL_TEST_MAX_SEC + 1);
+			}
+		}
+
+		auto End(const size_t& row) -> void {
+			lastSeen[row] = lastSeen.back();
+			lastSeen.pop_back();
+			table.Remove(row);
+		}
+
+		auto Advance(const int64_t& now) -> void {
+			wheel.Advance(now, [&](const uint32_t& id, const int64_t& tick) {
+				auto row = table.Find(id);
+				if (!row || table.expiry[*row] != tick) return;
+				table.expiry[*row] = 0;
+				if (now - lastSeen[*row] >= WHEEL_TEST_MAX_SEC) {
+					expired.push_back(table.callsign[*row]);
+					End(*row);
+				}
+				else {
+					table.expiry[*row] = wheel.Schedule(id, lastSeen[*row] + WHEEL_TEST_MAX_SEC + 1);
+				}
+				});
+		}
+	};
+
+}
+
+TEST(TimerWheel, FiresOnceAtScheduledTick)
+{
+	TimerWheel<int> wheel;
+	EXPECT_EQ(wheel.Schedule(1, 5), 5);
+	EXPECT_EQ(wheel.Schedule(2, 5 + TIMER_WHEEL_SLOTS), 5 + (int64_t)TIMER_WHEEL_SLOTS); // same slot, next round
+	std::vector<std::pair<int, int64_t>> fired;
+	auto Record = [&](const int& key, const int64_t& tick) { fired.emplace_back(key, tick); };
+	wheel.Advance(4, Record);
+	EXPECT_TRUE(fired.empty());
+	wheel.Advance(5, Record);
+	EXPECT_EQ(fired, (std::vector<std::pair<int, int64_t>>{ { 1, 5 } }));
+	EXPECT_EQ(wheel.Schedule(3, 0), 6); // past ticks fire on the next one
+	wheel.Advance(1000, Record); // skips more than a round
+	EXPECT_EQ(fired.size(), 3u);
+	EXPECT_EQ(wheel.Size(), 0u);
+}
+
+TEST(TimerWheel, TouchesKeepOneEntryPerRow)
+{
+	ExpiryHarness harness;
+	harness.Begin(0, "DLH1", 0);
+	size_t maxEntries = 0;
+	for (int64_t now = 1; now <= WHEEL_TEST_TOUCHES; now++) {
+		harness.Touch(*harness.table.Find(0), now);
+		harness.Advance(now);
+		maxEntries = std::max(maxEntries, harness.wheel.Size());
+	}
+	EXPECT_EQ(maxEntries, 1u);
+	EXPECT_TRUE(harness.expired.empty());
+
+	// silent from here, expires one limit after the last touch
+	harness.Advance(WHEEL_TEST_TOUCHES + WHEEL_TEST_MAX_SEC - 1);
+	EXPECT_TRUE(harness.expired.empty());
+	harness.Advance(WHEEL_TEST_TOUCHES + WHEEL_TEST_MAX_SEC + 1);
+	EXPECT_EQ(harness.expired, (std::vector<inline_callsign>{ inline_callsign("DLH1") }));
+	EXPECT_EQ(harness.wheel.Size(), 0u);
+}
+
+TEST(TimerWheel, StaleEntryDoesNotExpireReusedId)
+{
+	ExpiryHarness harness;
+	harness.Begin(0, "OLD1", 0); // entry at 61
+	harness.End(*harness.table.Find(0)); // kRxEnd, the entry stays in the wheel
+	harness.Begin(0, "NEW2", 30); // same ID, entry at 91
+	EXPECT_EQ(harness.wheel.Size(), 2u);
+	for (int64_t now = 31; now <= 80; now++) { // NEW2 keeps transmitting
+		harness.Touch(*harness.table.Find(0), now);
+		harness.Advance(now);
+	}
+	EXPECT_TRUE(harness.expired.empty()); // the entry of OLD1 fired at 61 and was dropped
+	EXPECT_EQ(harness.wheel.Size(), 1u);
+	harness.Advance(80 + WHEEL_TEST_MAX_SEC + 1);
+	EXPECT_EQ(harness.expired, (std::vector<inline_callsign>{ inline_callsign("NEW2") }));
+}
+
+TEST(TimerWheel, RestartContinuesFromEarlierTick)
+{
+	// replay moves the transmission clock back behind the last serviced tick
+	TimerWheel<int> wheel;
+	wheel.Schedule(1, 1000);
+	wheel.Advance(1000, [](const int&, const int64_t&) {});
+	wheel.Schedule(2, 1010);
+	wheel.Restart(100);
+	EXPECT_EQ(wheel.Size(), 0u);
+	EXPECT_EQ(wheel.Schedule(3, 161), 161); // not clamped to 1001
+	std::vector<int> fired;
+	wheel.Advance(160, [&](const int& key, const int64_t&) { fired.push_back(key); });
+	EXPECT_TRUE(fired.empty());
+	wheel.Advance(161, [&](const int& key, const int64_t&) { fired.push_back(key); });
+	EXPECT_EQ(fired, (std::vector<int>{ 3 }));
+}
@@ -0,0 +1,107 @@
+// TrackAudioRestartTest.cpp : recovery after the TrackAudio stand-in is killed and restarted, needs ixwebsocket
+
+#include <gtest/gtest.h>
+#include <ixwebsocket/IXNetSystem.h>
+#include <ixwebsocket/IXWebSocket.h>
+#include <memory>
+#include <thread>
+
+#include "RDFReconnect.h"
+#include "RDFReconnectProbe.h"
+#include "TrackAudioStandIn.h"
+
+namespace {
+
+	constexpr auto RECONNECT_TEST_PORT = 49181; // not the TrackAudio default, a running TrackAudio does not interfere
+	constexpr auto RECONNECT_TEST_ADDRESS = "127.0.0.1:49181";
+	constexpr auto RECONNECT_TEST_RECOVERY_MS = 2000; // endpoint back -> WS open, well below TRACKAUDIO_RECONNECT_MAX_MS plus a probe interval
+	constexpr auto RECONNECT_TEST_TICK_MS = 50; // stands in for the 1 s OnTimer
+	constexpr auto RECONNECT_TEST_TIMEOUT_SEC = 20;
+
+	// TrackAudio socket wired to ReconnectDriver like CRDFPlugin, Tick runs where the EuroScope thread would
+	class ReconnectClient
+	{
+	public:
+		ix::WebSocket socket;
+		ReconnectDriver<ix::WebSocket> reconnect{ socket };
+		std::atomic_int opened = 0;
+		std::atomic_bool posted = false; // WM_RDF_RECONNECT
+
+		ReconnectClient(void) {
+			socket.setUrl(std::string("ws://") + RECONNECT_TEST_ADDRESS + "/ws");
+			socket.setHandshakeTimeout(1);
+			reconnect.Reset();
+			socket.setOnMessageCallback([this](const ix::WebSocketMessagePtr& msg) {
+				if (msg->type == ix::WebSocketMessageType::Open) {
+					reconnect.Reset();
+					opened++;
+				}
+				else if (msg->type == ix::WebSocketMessageType::Error) {
+					reconnect.Failed(msg->errorInfo.retries);
+				}
+				});
+		}
+
+		~ReconnectClient(void) {
+			reconnect.Join();
+			socket.stop();
+		}
+
+		auto Closed(void) -> bool {
+			return socket.getReadyState() == ix::ReadyState::Closed;
+		}
+
+		auto Tick(void) -> void {
+			if (posted.exchange(false)) { // HiddenWndReconnectTrackAudio
+				reconnect.Restart(Closed());
+			}
+			reconnect.Tick(Closed(), [this]() { // OnTimer
+				if (!ProbeEndpoint(RECONNECT_TEST_ADDRESS, 1)) return false;
+				posted = true;
+				return true;
+				});
+		}
+
+		// ticks until pred holds, false on timeout
+		auto TickUntil(const std::function<bool(void)>& pred, const std::chrono::milliseconds& timeout) -> bool {
+			auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (!pred()) {
+				if (std::chrono::steady_clock::now() > deadline) return false;
+				Tick();
+				std::this_thread::sleep_for(std::chrono::milliseconds(RECONNECT_TEST_TICK_MS));
+			}
+			return true;
+		}
+	};
+
+}
+
+TEST(ReconnectDriver, RecoversAfterTrackAudioRestart)
+{
+	ix::initNetSystem();
+	std::string error;
+	auto standIn = std::make_unique<TrackAudioStandIn>(RECONNECT_TEST_PORT);
+	ASSERT_TRUE(standIn->Start(error)) << error;
+	{
+		ReconnectClient client;
+		client.socket.start();
+		ASSERT_TRUE(client.TickUntil([&]() { return client.opened == 1; }, std::chrono::seconds(RECONNECT_TEST_TIMEOUT_SEC)));
+
+		// kill: backoff grows until the probe takes over
+		standIn.reset();
+		ASSERT_TRUE(client.TickUntil([&]() { return client.reconnect.Wait() > TRACKAUDIO_PROBE_MIN_WAIT_MS; }, std::chrono::seconds(RECONNECT_TEST_TIMEOUT_SEC)));
+		EXPECT_EQ(client.opened, 1);
+
+		// restart: the connection is back within the bound, not after the backoff
+		standIn = std::make_unique<TrackAudioStandIn>(RECONNECT_TEST_PORT);
+		ASSERT_TRUE(standIn->Start(error)) << error;
+		auto restarted = std::chrono::steady_clock::now();
+		ASSERT_TRUE(client.TickUntil([&]() { return client.opened == 2; }, std::chrono::seconds(RECONNECT_TEST_TIMEOUT_SEC)));
+		auto recovery = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - restarted);
+		EXPECT_LT(recovery.count(), RECONNECT_TEST_RECOVERY_MS);
+		EXPECT_EQ(client.reconnect.Wait(), (uint32_t)TRACKAUDIO_RECONNECT_MIN_MS);
+		EXPECT_TRUE(client.TickUntil([&]() { return standIn->Clients() == 1; }, std::chrono::seconds(1)));
+	}
+	standIn.reset();
+	ix::uninitNetSystem();
+}
@@ -0,0 +1,175 @@
+// TransmissionTableTest.cpp : ID-keyed transmission rows, swap-remove and churn at 1, 10 and 100 transmitters
+
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+#include <random>
+
+#include "RDFTransmissionTable.h"
+
+namespace {
+
+	constexpr int TABLE_TEST_ROUNDS = 1000; // formerly .RDF LOADTEST TABLE
+	constexpr int TABLE_TEST_OPS = 100000;
+	constexpr uint32_t TABLE_TEST_IDS = 200;
+
+	auto Position(const double& lat) -> draw_position {
+		draw_position dp;
+		dp.sample.latitude = lat;
+		dp.sample.longitude = -lat;
+		dp.sample.altitude = (int)lat; // cold column follows the row
+		return dp;
+	}
+
+	// every row is found through its ID and carries the values of its ID
+	auto ExpectConsistent(const TransmissionTable& table, const std::map<uint32_t, double>& expected) -> void {
+		ASSERT_EQ(table.Size(), expected.size());
+		for (const auto& [id, lat] : expected) {
+			auto row = table.Find(id);
+			ASSERT_TRUE(row) << id;
+			EXPECT_EQ(table.id[*row], id);
+			EXPECT_EQ(table.latitude[*row], lat);
+			EXPECT_EQ(table.sample[*row].altitude, (int)lat);
+			EXPECT_EQ(table.callsign[*row], inline_callsign("CS" + std::to_string(id)));
+		}
+	}
+
+}
+
+TEST(TransmissionTable, IndexFollowsSwapRemove)
+{
+	TransmissionTable table;
+	std::map<uint32_t, double> expected;
+	std::mt19937 rd(1);
+	std::uniform_int_distribution<uint32_t> disId(0, TABLE_TEST_IDS - 1);
+	for (int i = 0; i < TABLE_TEST_OPS; i++) {
+		uint32_t id = disId(rd);
+		if (rd() % 3) {
+			table.Set(id, inline_callsign("CS" + std::to_string(id)), Position(i));
+			expected[id] = i;
+		}
+		else if (auto row = table.Find(id)) {
+			table.Remove(*row);
+			expected.erase(id);
+		}
+		else {
+			EXPECT_FALSE(expected.contains(id));
+		}
+	}
+	ExpectConsistent(table, expected);
+
+	// a copy keeps its own index, Append indexes the copied row
+	TransmissionTable snapshot = table;
+	TransmissionTable filtered;
+	for (const auto& [id, lat] : expected) {
+		if (id % 2) filtered.Append(table, *table.Find(id));
+	}
+	table.Clear();
+	EXPECT_TRUE(table.Empty());
+	EXPECT_FALSE(table.Find(expected.begin()->first));
+	ExpectConsistent(snapshot, expected);
+	std::erase_if(expected, [](const auto& e) { return !(e.first % 2); });
+	ExpectConsistent(filtered, expected);
+}
+
+TEST(TransmissionTable, SetOverwritesInPlace)
+{
+	TransmissionTable table;
+	size_t a = table.Set(7, inline_callsign("AAA"), Position(1.0));
+	table.Set(3, inline_callsign("BBB"), Position(2.0));
+	EXPECT_EQ(table.Set(7, inline_callsign("AAA"), Position(5.0), 1), a);
+	EXPECT_EQ(table.Size(), 2u);
+	EXPECT_EQ(table.latitude[a], 5.0);
+	EXPECT_EQ(table.flags[a], 1);
+	EXPECT_FALSE(table.Find(0));
+	EXPECT_FALSE(table.Find(100)); // beyond the index
+	table.Remove(a); // BBB moves into row a
+	EXPECT_EQ(table.Find(3), a);
+	EXPECT_FALSE(table.Find(7));
+	EXPECT_EQ(table.callsign[*table.Find(3)], inline_callsign("BBB"));
+}
+
+TEST(FrequencyIndex, ReceptionsByCallsignId)
+{
+	FrequencyIndex index;
+	EXPECT_TRUE(index.Add(1, 118000));
+	EXPECT_FALSE(index.Add(1, 118000)); // pair already open
+	EXPECT_TRUE(index.Add(1, 121500));
+	EXPECT_TRUE(index.Add(2, 118000));
+	EXPECT_EQ(index.Count(1), 2u);
+	std::vector<uint32_t> on118;
+	index.ForEach([](const int& f) { return f == 118000; }, [&](const uint32_t& id) { on118.push_back(id); });
+	std::sort(on118.begin(), on118.end());
+	EXPECT_EQ(on118, (std::vector<uint32_t>{ 1, 2 }));
+	EXPECT_TRUE(index.Remove(1, 118000));
+	EXPECT_FALSE(index.Remove(1, 118000));
+	EXPECT_EQ(index.Count(1), 1u);
+	index.RemoveAll(1);
+	EXPECT_EQ(index.Count(1), 0u);
+	EXPECT_EQ(index.Count(2), 1u);
+}
+
+TEST(TransmissionTable, ChurnTime)
+{
+	// begin, keep-alive, snapshot, draw pass and end, as in the plugin
+	for (const int n : { 1, 10, 100 }) {
+		CallsignInterner ids;
+		std::vector<inline_callsign> callsigns;
+		for (int i = 0; i < n; i++) {
+			callsigns.emplace_back("LT" + std::to_string(i));
+		}
+		TransmissionTable table;
+		draw_position dp;
+		volatile double sink = 0; // keeps the draw pass
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < TABLE_TEST_ROUNDS; r++) {
+			for (const auto& cs : callsigns) { // kRxBegin
+				table.Set(ids.Acquire(cs), cs, dp);
+			}
+			for (const auto& cs : callsigns) { // keep-alive
+				auto id = ids.Find(cs);
+				if (auto row = id ? table.Find(*id) : std::nullopt) table.lastSeen[*row] = start;
+			}
+			TransmissionTable snapshot = table; // GetDrawGeometry
+			for (size_t i = 0; i < snapshot.Size(); i++) { // OnRefresh
+				sink = sink + snapshot.latitude[i] + snapshot.radius[i];
+			}
+			for (auto cs = callsigns.rbegin(); cs != callsigns.rend(); cs++) { // kRxEnd
+				auto id = ids.Find(*cs);
+				if (auto row = id ? table.Find(*id) : std::nullopt) {
+					table.Remove(*row);
+					ids.Release(*id);
+				}
+			}
+		}
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		EXPECT_TRUE(table.Empty());
+		EXPECT_EQ(ids.Size(), 0u);
+		EXPECT_LE(ids.Capacity(), (size_t)n);
+		RecordProperty("ns_per_transmission_" + std::to_string(n), std::to_string(us * 1000.0 / ((double)TABLE_TEST_ROUNDS * n)));
+		std::cout << n << " transmitters: " << TABLE_TEST_ROUNDS << " rounds in " << us << " us ("
+			<< us * 1000.0 / ((double)TABLE_TEST_ROUNDS * n) << " ns per transmission)" << std::endl;
+	}
+}
+
+TEST(TrackFilter, LoosestScreenDecides)
+{
+	position_sample aircraft;
+	aircraft.altitude = 1500;
+	position_sample controller;
+	controller.controller = true;
+
+	track_filter none;
+	EXPECT_FALSE(none.Tracks(aircraft)); // no settings loaded yet
+	EXPECT_FALSE(none.Tracks(controller));
+
+	track_filter filter;
+	filter.Add(2000, false); // plugin settings
+	EXPECT_FALSE(filter.Tracks(aircraft)); // below every screen
+	EXPECT_FALSE(filter.Tracks(controller));
+	filter.Add(1000, true); // one screen draws lower and draws controllers
+	EXPECT_TRUE(filter.Tracks(aircraft));
+	EXPECT_TRUE(filter.Tracks(controller));
+	aircraft.altitude = 999;
+	EXPECT_FALSE(filter.Tracks(aircraft));
+}
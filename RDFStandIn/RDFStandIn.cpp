@@ -0,0 +1,162 @@
+// RDFStandIn.cpp : TrackAudio stand-in server and load generator for the RDF plugin
+//
+// RDFStandIn [--port <port>] [--station <callsign>:<Hz>]... <scenario>
+//   serve                                  serves station states until killed
+//   rx <events per second> <seconds> <callsign>...
+//                                          overlapping kRxBegin/kRxEnd pairs of 0.5~5 s
+//   states <updates>                       kStationStateUpdate storm, RX, then TX, then XC
+// The plugin is pointed at the stand-in with TrackAudio address 127.0.0.1:<port>.
+// Plugin side handling time is read with .RDF STATS after a run.
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <map>
+#include <ixwebsocket/IXNetSystem.h>
+
+#include "TrackAudioStandIn.h"
+
+namespace {
+
+	constexpr auto STANDIN_CONNECT_TIMEOUT_SEC = 60; // waiting for the plugin to connect
+	constexpr auto STANDIN_RX_FREQUENCY_HZ = 122800000; // frequency reported in kRxBegin/kRxEnd
+
+	auto Usage(void) -> int {
+		std::cerr << "usage: RDFStandIn [--port <port>] [--station <callsign>:<Hz>]... serve | rx <events per second> <seconds> <callsign>... | states <updates>" << std::endl;
+		return 2;
+	}
+
+	auto WaitForClient(TrackAudioStandIn& standIn) -> bool {
+		std::cout << "waiting for the plugin to connect" << std::endl;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(STANDIN_CONNECT_TIMEOUT_SEC);
+		while (!standIn.Clients()) {
+			if (std::chrono::steady_clock::now() > deadline) return false;
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(500)); // kGetStationStates round trip
+		return true;
+	}
+
+	auto RunRx(TrackAudioStandIn& standIn, const int& rate, const int& seconds, const std::vector<std::string>& callsigns) -> void {
+		// every begin and end counts as one event
+		std::mt19937 rdGenerator(std::random_device{}());
+		std::uniform_int_distribution<size_t> disCallsign(0, callsigns.size() - 1);
+		std::uniform_int_distribution<int> disHold(500, 5000); // ms
+		std::multimap<std::chrono::steady_clock::time_point, std::string> pendingEnd;
+		auto period = std::chrono::nanoseconds(1000000000LL / rate);
+		auto next = std::chrono::steady_clock::now();
+		auto finish = next + std::chrono::seconds(seconds);
+		while (next < finish) {
+			auto now = std::chrono::steady_clock::now();
+			if (next - now > std::chrono::milliseconds(1)) { // sleep granularity is coarse, catch up in bursts
+				std::this_thread::sleep_until(next);
+				now = std::chrono::steady_clock::now();
+			}
+			next += period;
+			if (!pendingEnd.empty() && pendingEnd.begin()->first <= now) {
+				standIn.RxEnd(pendingEnd.begin()->second, STANDIN_RX_FREQUENCY_HZ);
+				pendingEnd.erase(pendingEnd.begin());
+			}
+			else {
+				const auto& callsign = callsigns[disCallsign(rdGenerator)];
+				pendingEnd.emplace(now + std::chrono::milliseconds(disHold(rdGenerator)), callsign);
+				standIn.RxBegin(callsign, STANDIN_RX_FREQUENCY_HZ);
+			}
+		}
+		for (const auto& [t, callsign] : pendingEnd) { // close what is left open
+			standIn.RxEnd(callsign, STANDIN_RX_FREQUENCY_HZ);
+		}
+	}
+
+	auto RunStates(TrackAudioStandIn& standIn, const int& updates, const std::vector<standin_station>& stations) -> void {
+		// what TrackAudio sends when a position is set up, several updates per station within milliseconds
+		for (int i = 0; i < updates; i++) {
+			auto station = stations[i % stations.size()];
+			int step = (int)(i / stations.size()) % 3;
+			station.rx = true;
+			station.tx = step >= 1;
+			station.xc = step >= 2;
+			standIn.StationUpdate(station);
+		}
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	int port = STANDIN_DEFAULT_PORT;
+	std::vector<standin_station> stations;
+	int arg = 1;
+	for (; arg + 1 < argc && std::string(argv[arg]).starts_with("--"); arg += 2) {
+		std::string option = argv[arg], value = argv[arg + 1];
+		if (option == "--port") {
+			port = std::stoi(value);
+		}
+		else if (option == "--station") {
+			auto sep = value.rfind(':');
+			if (sep == std::string::npos) return Usage();
+			stations.push_back({ value.substr(0, sep), std::stoi(value.substr(sep + 1)) });
+		}
+		else {
+			return Usage();
+		}
+	}
+	if (arg >= argc) return Usage();
+	std::string scenario = argv[arg++];
+	if (stations.empty()) {
+		stations = { { "EDDF_TWR", 119905000 }, { "EDDF_GND", 121805000 }, { "EDDF_APP", 120805000 }, { "EDDF_DEL", 121905000 }, { "EDDF_ATIS", 118030000 } };
+	}
+
+	ix::initNetSystem();
+	TrackAudioStandIn standIn(port);
+	for (auto station : stations) {
+		station.rx = true;
+		standIn.SetStation(station);
+	}
+	std::string error;
+	if (!standIn.Start(error)) {
+		std::cerr << "unable to listen on " << port << ": " << error << std::endl;
+		return 1;
+	}
+	std::cout << "TrackAudio stand-in on ws://127.0.0.1:" << port << "/ws" << std::endl;
+
+	int rc = 0;
+	auto start = std::chrono::steady_clock::now();
+	if (scenario == "serve") {
+		while (true) {
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+		}
+	}
+	else if (scenario == "rx" && arg + 2 < argc) {
+		int rate = std::stoi(argv[arg]), seconds = std::stoi(argv[arg + 1]);
+		std::vector<std::string> callsigns(argv + arg + 2, argv + argc);
+		if (rate <= 0 || !WaitForClient(standIn)) {
+			rc = 1;
+		}
+		else {
+			start = std::chrono::steady_clock::now();
+			RunRx(standIn, rate, seconds, callsigns);
+		}
+	}
+	else if (scenario == "states" && arg < argc) {
+		int updates = std::stoi(argv[arg]);
+		if (updates <= 0 || !WaitForClient(standIn)) {
+			rc = 1;
+		}
+		else {
+			start = std::chrono::steady_clock::now();
+			RunStates(standIn, updates, stations);
+			std::this_thread::sleep_for(std::chrono::seconds(1)); // kSetStationState echoes in mode 2
+		}
+	}
+	else {
+		rc = Usage();
+	}
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << scenario << ": " << standIn.FramesSent() << " frames sent in " << elapsed << " s, "
+		<< standIn.FramesReceived() << " frames received" << std::endl;
+	standIn.Stop();
+	ix::uninitNetSystem();
+	return rc;
+}
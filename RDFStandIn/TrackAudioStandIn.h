@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <ixwebsocket/IXHttpServer.h>
+#include <nlohmann/json.hpp>
+
+// Stand-in for the TrackAudio SDK endpoint (ws://host:port/ws and http://host:port/*), portable
+// Serves kGetStationStates and kSetStationState like TrackAudio does and broadcasts
+// kRxBegin, kRxEnd and kStationStateUpdate on request. Plain HTTP requests get the
+// version, WebSocket upgrades are handed to the WebSocket server underneath.
+constexpr auto STANDIN_DEFAULT_PORT = 49080; // TrackAudio default
+constexpr auto STANDIN_VERSION = "RDFStandIn"; // reported on /*
+
+typedef struct _standin_station {
+	std::string callsign;
+	int frequency = 0; // Hz
+	bool rx = false;
+	bool tx = false;
+	bool xc = false;
+} standin_station;
+
+class TrackAudioStandIn
+{
+private:
+	ix::HttpServer server;
+	std::mutex mtx;
+	std::vector<standin_station> stations;
+	std::atomic_size_t framesSent = 0;
+	std::atomic_size_t framesReceived = 0;
+
+	static auto StationJson(const standin_station& station) -> nlohmann::json {
+		nlohmann::json value;
+		value["callsign"] = station.callsign;
+		value["frequency"] = station.frequency;
+		value["rx"] = station.rx;
+		value["tx"] = station.tx;
+		value["xc"] = station.xc;
+		value["xca"] = false;
+		value["headset"] = true;
+		value["isAvailable"] = true;
+		return value;
+	}
+
+	static auto OnRequest(const ix::HttpRequestPtr& request) -> ix::HttpResponsePtr {
+		ix::WebSocketHttpHeaders headers;
+		headers["Server"] = "TrackAudio-SDK";
+		if (request->method != "GET" || request->uri != "/*") {
+			return std::make_shared<ix::HttpResponse>(404, "Not Found", ix::HttpErrorCode::Ok, headers, std::string());
+		}
+		headers["Content-Type"] = "application/json";
+		nlohmann::json value;
+		value["version"] = STANDIN_VERSION;
+		return std::make_shared<ix::HttpResponse>(200, "OK", ix::HttpErrorCode::Ok, headers, value.dump());
+	}
+
+	auto OnMessage(ix::WebSocket& client, const ix::WebSocketMessagePtr& msg) -> void {
+		if (msg->type != ix::WebSocketMessageType::Message) return;
+		framesReceived++;
+		auto data = nlohmann::json::parse(msg->str, nullptr, false);
+		if (data.is_discarded() || !data.contains("type")) return;
+		if (data["type"] == "kGetStationStates") {
+			nlohmann::json reply;
+			reply["type"] = "kStationStates";
+			reply["value"]["stations"] = nlohmann::json::array();
+			std::unique_lock lock(mtx);
+			for (const auto& station : stations) {
+				reply["value"]["stations"].push_back({ { "type", "kStationStateUpdate" }, { "value", StationJson(station) } });
+			}
+			lock.unlock();
+			client.send(reply.dump());
+			framesSent++;
+		}
+		else if (data["type"] == "kSetStationState" && data.contains("value")) {
+			// TrackAudio matches the station by frequency and answers with its new state
+			const auto& value = data["value"];
+			int frequency = value.value("frequency", 0);
+			std::unique_lock lock(mtx);
+			auto station = std::find_if(stations.begin(), stations.end(), [&](const standin_station& s) { return s.frequency == frequency; });
+			if (station == stations.end()) return;
+			station->rx = value.value("rx", station->rx);
+			station->tx = value.value("tx", station->tx);
+			station->xc = value.value("xc", station->xc);
+			auto update = *station;
+			lock.unlock();
+			StationUpdate(update);
+		}
+	}
+
+public:
+	TrackAudioStandIn(const int& port = STANDIN_DEFAULT_PORT, const std::string& host = "127.0.0.1") :
+		server(port, host)
+	{
+		server.setOnConnectionCallback([](ix::HttpRequestPtr request, std::shared_ptr<ix::ConnectionState>) {
+			return OnRequest(request);
+			});
+		server.setOnClientMessageCallback([this](std::shared_ptr<ix::ConnectionState>, ix::WebSocket& client, const ix::WebSocketMessagePtr& msg) {
+			OnMessage(client, msg);
+			});
+	}
+
+	~TrackAudioStandIn(void) {
+		Stop();
+	}
+
+	auto Start(std::string& error) -> bool {
+		auto [ok, reason] = server.listen();
+		if (!ok) {
+			error = reason;
+			return false;
+		}
+		server.start();
+		return true;
+	}
+
+	// closes all clients, like TrackAudio quitting
+	auto Stop(void) -> void {
+		server.stop();
+	}
+
+	auto Clients(void) -> size_t {
+		return server.getClients().size();
+	}
+
+	auto FramesSent(void) const -> size_t {
+		return framesSent;
+	}
+
+	auto FramesReceived(void) const -> size_t {
+		return framesReceived;
+	}
+
+	auto Broadcast(const nlohmann::json& jmsg) -> void {
+		auto frame = jmsg.dump();
+		for (const auto& client : server.getClients()) {
+			client->send(frame);
+			framesSent++;
+		}
+	}
+
+	// adds or replaces the station with the same frequency, without broadcasting
+	auto SetStation(const standin_station& station) -> void {
+		std::lock_guard lock(mtx);
+		auto it = std::find_if(stations.begin(), stations.end(), [&](const standin_station& s) { return s.frequency == station.frequency; });
+		if (it != stations.end()) {
+			*it = station;
+		}
+		else {
+			stations.push_back(station);
+		}
+	}
+
+	auto StationUpdate(const standin_station& station) -> void {
+		SetStation(station);
+		Broadcast({ { "type", "kStationStateUpdate" }, { "value", StationJson(station) } });
+	}
+
+	auto RxBegin(const std::string& callsign, const int& frequency) -> void {
+		Broadcast({ { "type", "kRxBegin" }, { "value", { { "callsign", callsign }, { "pFrequencyHz", frequency } } } });
+	}
+
+	auto RxEnd(const std::string& callsign, const int& frequency) -> void {
+		Broadcast({ { "type", "kRxEnd" }, { "value", { { "callsign", callsign }, { "pFrequencyHz", frequency } } } });
+	}
+};